@@ -0,0 +1,169 @@
+// Cycle-count benchmarks for the firmware, run under simavr (`make bench`).
+//
+// The application objects are linked in unchanged (main() is renamed to
+// app_main), Timer1 runs at clk/1 to count cycles, and every result is
+// printed over the USART as "BENCH <name> <cycles>".
+
+#include "include/adc.h"
+#include "include/board.h"
+#include "include/lcd.h"
+#include "include/main.h"
+#include "include/wheel.h"
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <util/setbaud.h>
+
+// firmware symbols
+extern LCD lcd;
+void TIMER1_COMPA_vect(void);
+void BOARD_KEYPAD_VECT(void);
+void TIMER0_COMPA_vect(void);
+
+#define BENCH_TIMERS 16 // armed software timers
+
+static volatile uint16_t overflows;
+static uint32_t overhead;
+static char line[17];
+static Timer timers[BENCH_TIMERS];
+
+static void timerDone() {}
+
+ISR(TIMER1_OVF_vect) { overflows++; }
+
+static void uartInit() {
+  UBRR0H = UBRRH_VALUE;
+  UBRR0L = UBRRL_VALUE;
+#if USE_2X
+  UCSR0A |= (1 << U2X0);
+#else
+  UCSR0A &= ~(1 << U2X0);
+#endif
+  UCSR0B = (1 << TXEN0);
+  UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);
+}
+
+static void uartPrint(const char *str) {
+  while (*str) {
+    while (!(UCSR0A & (1 << UDRE0)))
+      ;
+    UDR0 = *str++;
+  }
+}
+
+static void cyclesStart() {
+  // Timer1 at clk/1, overflows counted in TIMER1_OVF_vect
+  TCCR1A = 0;
+  TCCR1B = 0;
+  TCNT1 = 0;
+  overflows = 0;
+  TIFR1 = (1 << TOV1);
+  TIMSK1 = (1 << TOIE1);
+  TCCR1B = (1 << CS10);
+}
+
+static uint32_t cyclesStop() {
+  TCCR1B = 0;
+  uint16_t low = TCNT1;
+  // account for an overflow that happened while interrupts were off
+  if (TIFR1 & (1 << TOV1)) {
+    overflows++;
+    TIFR1 = (1 << TOV1);
+  }
+  TIMSK1 = 0;
+  return ((uint32_t)overflows << 16) + low;
+}
+
+static void report(const char *name, uint32_t cycles) {
+  char out[40];
+  cycles = (cycles > overhead) ? cycles - overhead : 0;
+  snprintf(out, sizeof(out), "BENCH %s %lu\n", name, cycles);
+  uartPrint(out);
+}
+
+#define BENCH(name, code)                                                      \
+  do {                                                                         \
+    cyclesStart();                                                             \
+    code;                                                                      \
+    report(name, cyclesStop());                                                \
+  } while (0)
+
+int main() {
+  uartInit();
+  adcInit();
+  lcd = lcdInit(BOARD_LCD_RS, BOARD_LCD_EN, BOARD_LCD_D4, BOARD_LCD_D5,
+                BOARD_LCD_D6, BOARD_LCD_D7, 16, 2, LCD_5x8DOTS);
+  sei();
+
+  // measure an empty run to subtract the timer start/stop overhead
+  cyclesStart();
+  overhead = cyclesStop();
+
+  // LCD driver
+  BENCH("lcdPrint_line", lcdPrint(lcd, "0123456789ABCDEF"));
+  BENCH("lcdSetCursor", lcdSetCursor(lcd, 1, 0));
+  BENCH("lcdClear", lcdClear(lcd));
+
+  BENCH("lcdPrint_P_line", lcdPrint_P(lcd, PSTR("0123456789ABCDEF")));
+
+  // every snprintf pattern used in src/main.c
+  BENCH("snprintf_status0",
+        snprintf_P(line, sizeof(line), PSTR("Temp:%dC Motor:%d"), 25, 1));
+  BENCH("snprintf_status1",
+        snprintf_P(line, sizeof(line), PSTR("Speed:%d%%of%d%%"), 45, 100));
+  BENCH("snprintf_digit", snprintf_P(line, sizeof(line), PSTR("%d"), 1));
+  BENCH("snprintf_msg", snprintf_P(line, sizeof(line), PSTR("%S"),
+                                   PSTR("Incorrect Pass")));
+  BENCH("snprintf_oldpass",
+        snprintf_P(line, sizeof(line), PSTR("Old Pass:%s"), "1212"));
+  BENCH("snprintf_newpass",
+        snprintf_P(line, sizeof(line), PSTR("New Pass:%s"), "12"));
+  BENCH("snprintf_clock",
+        snprintf_P(line, sizeof(line), PSTR("%02d:%02d:%02d"), 18, 30, 59));
+  BENCH("snprintf_speed",
+        snprintf_P(line, sizeof(line), PSTR("Max Speed:%d"), 100));
+  BENCH("snprintf_thresh",
+        snprintf_P(line, sizeof(line), PSTR("Thresh(C):%d"), 30));
+
+  // ADC and control loop
+  BENCH("adcRead", adcRead(1));
+  BENCH("motorControl", motorControl());
+
+  // the Makefile takes the control cost per zone from this and a build with
+  // zone 1 only
+  snprintf(line, sizeof(line), "ZONES %u\n", ZONE_COUNT);
+  uartPrint(line);
+
+  // interrupt handlers, called directly (they return with reti)
+  BENCH("isr_timer1_compa", TIMER1_COMPA_vect());
+  BENCH("isr_pcint1", BOARD_KEYPAD_VECT());
+  BENCH("isr_timer0_compa", TIMER0_COMPA_vect());
+
+  // software timers, the per-tick cost with BENCH_TIMERS armed and none or
+  // one of them due (timer 0 isn't running, ticks are made by hand)
+  wheelRun();
+  for (uint8_t i = 0; i < BENCH_TIMERS; i++) {
+    timerArm(&timers[i], 100 + i * 37, 0, timerDone);
+  }
+  TIMER0_COMPA_vect();
+  BENCH("wheelRun_tick", wheelRun());
+  timerArm(&timers[0], 1, 0, timerDone);
+  TIMER0_COMPA_vect();
+  BENCH("wheelRun_expire", wheelRun());
+  BENCH("timerArm", timerArm(&timers[1], 500, 0, timerDone));
+  BENCH("timerCancel", timerCancel(&timers[1]));
+
+  uartPrint("BENCH_DONE\n");
+
+  // simavr exits when the core sleeps with interrupts disabled
+  while (!(UCSR0A & (1 << TXC0)))
+    ;
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  cli();
+  sleep_mode();
+
+  return 0;
+}
@@ -0,0 +1,56 @@
+#!/bin/sh
+# Compare benchmark results against the checked-in baseline.
+# usage: compare.sh <baseline> <results> <threshold-percent> [unit]
+# Fails if any benchmark is more than <threshold-percent> slower, if one in the
+# baseline is missing from the results, or if there is no baseline to compare
+# with. The unit (cycles by default) only names the column.
+
+baseline="$1"
+results="$2"
+threshold="$3"
+unit="${4:-cycles}"
+
+if [ ! -s "$results" ]; then
+  echo "bench: no results in $results" >&2
+  exit 1
+fi
+
+if [ ! -f "$baseline" ]; then
+  echo "bench: no baseline at $baseline," \
+       "record one with the _baseline target" >&2
+  cat "$results"
+  exit 1
+fi
+
+awk -v threshold="$threshold" -v unit="$unit" '
+  BEGIN { printf "%-36s %10s %10s %8s\n", "benchmark", "baseline", unit, "change" }
+  NR == FNR { base[$1] = $2; next }
+  {
+    seen[$1] = 1
+    if (!($1 in base)) {
+      printf "%-36s %10s %10d %8s\n", $1, "-", $2, "new"
+      next
+    }
+    if (base[$1] > 0) {
+      diff = ($2 - base[$1]) * 100.0 / base[$1]
+    } else {
+      # anything at all where there was nothing counts as a regression
+      diff = ($2 > 0) ? 100 : 0
+    }
+    flag = ""
+    if (diff > threshold) {
+      flag = "  REGRESSION"
+      failed = 1
+    }
+    printf "%-36s %10d %10d %+7.2f%%%s\n", $1, base[$1], $2, diff, flag
+  }
+  END {
+    for (name in base) {
+      if (!(name in seen)) {
+        printf "%-36s %10d %10s %8s  MISSING\n", name, base[name], "-", "-"
+        failed = 1
+      }
+    }
+    exit failed
+  }
+' "$baseline" "$results"
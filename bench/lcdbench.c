@@ -0,0 +1,226 @@
+// Bus traffic of the screen transitions, measured on the HD44780 model
+// (`make lcdbench`).
+//
+// The firmware is built for the host as for the trace replay and a script
+// presses the keys, walking through every screen of src/main.c. For every
+// step it prints the instructions, the data bytes and the least time the
+// LCD bus needed for them (us) as "BENCH <step>.<count> <value>", followed
+// by the screen. A step counts everything sent until the next one, periodic
+// redraws included. It fails if the bus timing was violated.
+
+#include "include/main.h"
+#include "include/trace.h"
+#include "include/util.h"
+#include "replay/board.h"
+#include "replay/hd44780.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VISIBLE_COLS 16 // of the LCD
+#define WAKE 0xFF       // a key press only seen by the keypad interrupt
+#define RELEASED 0x3FF  // keypad reading without a key
+#define SENSOR 256      // temperature sensor readings
+#define BANDGAP 225     // 1.1V with a 5V supply
+
+typedef struct {
+  const char *name;
+  uint8_t key; // Input, or WAKE
+  uint16_t ms; // until the next step
+} Step;
+
+static const Step script[] = {
+    {"boot", NOINPUT, 1000},
+    {"status_refresh", NOINPUT, 1000},
+    {"status_to_pass", WAKE, 1000},
+    {"pass_digit_1", UP, 1000},
+    {"pass_digit_2", DOWN, 1000},
+    {"pass_digit_3", UP, 1000},
+    {"pass_digit_4", DOWN, 1000},
+    {"pass_to_menu", ENTER, 1000},
+    {"menu_down", DOWN, 1000},
+    {"menu_scroll_down", DOWN, 1000},
+    {"menu_up", UP, 1000},
+    {"menu_scroll_up", UP, 1000},
+    {"menu_to_settings", ENTER, 1000},
+    {"settings_to_change_pass", ENTER, 1000},
+    {"change_pass_digit_1", UP, 1000},
+    {"change_pass_short", ENTER, 1200},
+    {"change_pass_marquee", NOINPUT, 3000}, // only the display shifts
+    {"change_pass_short_end", NOINPUT, 1800},
+    {"change_pass_digit_2", DOWN, 1000},
+    {"change_pass_digit_3", UP, 1000},
+    {"change_pass_digit_4", DOWN, 1000},
+    {"change_pass_save", ENTER, 2000},
+    {"settings_down_temp", DOWN, 1000},
+    {"settings_to_change_temp", ENTER, 1000},
+    {"change_temp_up", UP, 1000},
+    {"change_temp_save", ENTER, 2000},
+    {"change_temp_back", BACK, 1000},
+    {"settings_down_speed", DOWN, 1000},
+    {"settings_to_change_speed", ENTER, 1000},
+    {"change_speed_down", DOWN, 1000},
+    {"change_speed_back", BACK, 1000},
+    {"settings_down_curve", DOWN, 1000},
+    {"settings_to_change_curve", ENTER, 1000},
+    {"change_curve_up", UP, 1000},
+    {"change_curve_next", ENTER, 1000},
+    {"change_curve_prev", BACK, 1000},
+    {"change_curve_back", BACK, 1000},
+    {"settings_to_menu", BACK, 1000},
+    {"menu_down_clock", DOWN, 1000},
+    {"menu_to_clock", ENTER, 1000},
+    {"clock_to_change_time", ENTER, 1000},
+    {"change_time_up", UP, 1000},
+    {"change_time_next", ENTER, 1000},
+    {"change_time_next_2", ENTER, 1000},
+    {"change_time_save", ENTER, 2000},
+    {"clock_down_alarm", DOWN, 1000},
+    {"clock_to_set_alarm", ENTER, 1000},
+    {"set_alarm_up", UP, 1000},
+    {"set_alarm_back", BACK, 1000},
+    {"clock_to_menu", BACK, 1000},
+    {"menu_down_stats", DOWN, 1000},
+    {"menu_to_stats", ENTER, 1000},
+    {"stats_window", DOWN, 1000},
+    {"stats_refresh", NOINPUT, 1000},
+    {"stats_back", BACK, 1000},
+    {"menu_down_lock", DOWN, 1000},
+    {"menu_lock", ENTER, 1000},
+    {"wrong_to_pass", WAKE, 1000},
+    {"wrong_digit_1", DOWN, 1000},
+    {"wrong_digit_2", DOWN, 1000},
+    {"wrong_digit_3", DOWN, 1000},
+    {"wrong_digit_4", DOWN, 1000},
+    {"pass_wrong", ENTER, 2000},
+    {"short_to_pass", WAKE, 1000},
+    {"short_digit", UP, 1000},
+    {"pass_short", ENTER, 5000},
+    {"back_to_pass", WAKE, 1000},
+    {"pass_back", BACK, 1000},
+    {"timeout_to_pass", WAKE, 1000},
+    {"pass_timeout", NOINPUT, (TIMEOUT + 1) * 1000},
+};
+
+#define STEPS (sizeof(script) / sizeof(script[0]))
+
+static uint32_t now = 0;           // ms since reset
+static uint32_t stepEnd = 0;       // time the current step ends
+static uint8_t step = 0;           // in script
+static uint16_t keypad = RELEASED; // until the firmware reads it
+static uint8_t failed = 0;
+
+// keypad reading of a key, see getKeypad()
+static uint16_t reading(uint8_t key) {
+  switch (key) {
+  case UP:
+    return 130;
+  case DOWN:
+    return 310;
+  case ENTER:
+    return 20;
+  case BACK:
+    return 480;
+  }
+  return RELEASED;
+}
+
+static void begin() {
+  memset(&hd44780Stats, 0, sizeof(hd44780Stats));
+  stepEnd = now + script[step].ms;
+  if (script[step].key == WAKE) {
+    BOARD_KEYPAD_VECT();
+  } else {
+    keypad = reading(script[step].key);
+  }
+}
+
+static void finish() {
+  const char *name = script[step].name;
+
+  printf("BENCH %s.commands %lu\n", name,
+         (unsigned long)hd44780Stats.commands);
+  printf("BENCH %s.data %lu\n", name, (unsigned long)hd44780Stats.data);
+  printf("BENCH %s.bus_us %lu\n", name,
+         (unsigned long)((hd44780Stats.busTime + 999) / 1000));
+
+  printf("SCREEN %s %d |", name, currentState);
+  for (int row = 0; row < HD44780_ROWS; row++) {
+    for (int col = 0; col < VISIBLE_COLS; col++) {
+      uint8_t c = hd44780Char(row, col);
+      putchar(c < 0x20 || c > 0x7D ? '?' : c);
+    }
+    putchar('|');
+  }
+  putchar('\n');
+
+  if (hd44780Stats.violations) {
+    fprintf(stderr, "lcdbench: %s: %lu timing violations\n", name,
+            (unsigned long)hd44780Stats.violations);
+    failed = 1;
+  }
+}
+
+// the custom characters, if the firmware defined any
+static void printCgram() {
+  for (int addr = 0; addr < HD44780_CGRAM_SIZE; addr++) {
+    if (hd44780Cgram(addr)) {
+      break;
+    }
+    if (addr == HD44780_CGRAM_SIZE - 1) {
+      return;
+    }
+  }
+  for (int addr = 0; addr < HD44780_CGRAM_SIZE; addr++) {
+    uint8_t dots = hd44780Cgram(addr);
+    printf("CGRAM %d ", addr / 8);
+    for (int bit = 4; bit >= 0; bit--) {
+      putchar(dots & 1 << bit ? '#' : '.');
+    }
+    putchar('\n');
+  }
+}
+
+void replayStep() {
+  now++;
+  TIMER0_COMPA_vect();
+  TIMER0_COMPB_vect();
+  if (now % 1000 == 0) {
+    TIMER1_COMPA_vect();
+  }
+
+  if (now == stepEnd) {
+    finish();
+    if (++step == STEPS) {
+      printCgram();
+      exit(failed);
+    }
+    begin();
+  }
+}
+
+uint16_t traceReplayAdc(uint8_t channel) {
+  if (channel == BOARD_KEYPAD_ADC) {
+    // a key is held until it's been read once
+    uint16_t key = keypad;
+    keypad = RELEASED;
+    return key;
+  }
+  return channel == BOARD_ADC_BANDGAP ? BANDGAP : SENSOR;
+}
+
+int main() {
+  // settings of a configured board
+  Vars vars = {"1212", {12, 0, 0}, {6, 0, 0}};
+  memcpy(&boardEeprom[EEPROM_TIME], vars.time, sizeof(vars.time));
+  memcpy(&boardEeprom[EEPROM_ALARM], vars.alarm, sizeof(vars.alarm));
+  memcpy(&boardEeprom[EEPROM_PASSWORD], vars.password, sizeof(vars.password));
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    boardEeprom[EEPROM_ZONE_MAX_SPEED(z)] = MAX_SPEED;
+    boardEeprom[EEPROM_ZONE_THRESHOLD(z)] = 30;
+  }
+
+  begin();
+  return app_main();
+}
@@ -0,0 +1,136 @@
+// Closed-loop thermal simulation of the fan control (`make thermsim`).
+//
+// The firmware is built for the host as for the trace replay and every zone
+// is a lumped thermal mass heated by a load profile and cooled through its
+// fan, which lags behind the duty cycle. The sensor readings are fed back
+// through the ADC. For every zone it prints the peak temperature in
+// milli-degrees as "BENCH <zone>.peak_mC <value>", followed by the fan-on
+// time and the fan energy.
+
+#include "include/main.h"
+#include "include/trace.h"
+#include "replay/board.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RELEASED 0x3FF // keypad reading without a key
+#define BANDGAP 225    // 1.1V with a 5V supply
+#define RUN_MS 1200000 // 20 minutes
+#define THRESHOLD 30   // C, fan on above it
+
+// thermal model
+#define AMBIENT 25.0   // C
+#define CAPACITY 300.0 // J/C
+#define LOSS 1.0       // W/C with the fan off
+#define FAN_LOSS 6.0   // W/C more at full speed
+#define FAN_LAG 3000.0 // ms, time constant of the fan spinning up or down
+
+typedef struct {
+  uint32_t ms; // the load starts here
+  double watts;
+} Load;
+
+typedef struct {
+  const char *name;
+  Load loads[4]; // in time order, ends at a zero time
+} Profile;
+
+// one per zone, repeated if there are more zones
+static const Profile profiles[] = {
+    // a short burst, over before the temperature settles
+    {"burst", {{60000, 30}, {180000, 0}}},
+    // a load that creeps up, then stays
+    {"ramp", {{60000, 8}, {240000, 16}, {420000, 24}}},
+};
+
+#define PROFILES (sizeof(profiles) / sizeof(profiles[0]))
+
+static uint32_t now = 0; // ms since reset
+static double temp[ZONE_COUNT];
+static double fan[ZONE_COUNT]; // fan speed, 0 to 1
+static double peak[ZONE_COUNT];
+static double energy[ZONE_COUNT]; // full speed seconds
+static uint32_t fanOnMs[ZONE_COUNT];
+
+extern Zones zones;
+extern const uint8_t zoneSensor[ZONE_COUNT];
+
+static const Profile *profile(uint8_t zone) {
+  return &profiles[zone % PROFILES];
+}
+
+static double load(uint8_t zone) {
+  const Load *l = profile(zone)->loads;
+  double watts = 0;
+
+  for (; l->ms && l->ms <= now; l++) {
+    watts = l->watts;
+  }
+  return watts;
+}
+
+static void finish() {
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    printf("BENCH zone%u_%s.peak_mC %ld\n", z + 1, profile(z)->name,
+           (long)(peak[z] * 1000));
+  }
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    printf("zone %u %s: fan on for %lus, %.0f full speed seconds\n", z + 1,
+           profile(z)->name, (unsigned long)(fanOnMs[z] / 1000), energy[z]);
+  }
+}
+
+void replayStep() {
+  now++;
+  TIMER0_COMPA_vect();
+  TIMER0_COMPB_vect();
+  if (now % 1000 == 0) {
+    TIMER1_COMPA_vect();
+  }
+
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    double duty = zones.speed[z] / 100.0;
+    double loss = LOSS + FAN_LOSS * fan[z];
+
+    fan[z] += (duty - fan[z]) / FAN_LAG;
+    temp[z] += (load(z) - loss * (temp[z] - AMBIENT)) / CAPACITY / 1000;
+    if (temp[z] > peak[z]) {
+      peak[z] = temp[z];
+    }
+    energy[z] += fan[z] / 1000;
+    fanOnMs[z] += zones.motorOn[z];
+  }
+
+  if (now == RUN_MS) {
+    finish();
+    exit(0);
+  }
+}
+
+uint16_t traceReplayAdc(uint8_t channel) {
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    if (channel == zoneSensor[z]) {
+      double reading = temp[z] * 1024 / MAX_TEMP;
+      return reading > 1023 ? 1023 : (uint16_t)reading;
+    }
+  }
+  return channel == BOARD_ADC_BANDGAP ? BANDGAP : RELEASED;
+}
+
+int main() {
+  // settings of a configured board
+  Vars vars = {"1212", {12, 0, 0}, {6, 0, 0}};
+  memcpy(&boardEeprom[EEPROM_TIME], vars.time, sizeof(vars.time));
+  memcpy(&boardEeprom[EEPROM_ALARM], vars.alarm, sizeof(vars.alarm));
+  memcpy(&boardEeprom[EEPROM_PASSWORD], vars.password, sizeof(vars.password));
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    boardEeprom[EEPROM_ZONE_MAX_SPEED(z)] = MAX_SPEED;
+    boardEeprom[EEPROM_ZONE_THRESHOLD(z)] = THRESHOLD;
+    temp[z] = AMBIENT;
+    peak[z] = AMBIENT;
+  }
+
+  return app_main();
+}
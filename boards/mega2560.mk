@@ -0,0 +1,11 @@
+# ATmega2560 at 16MHz (Arduino Mega 2560), pins in include/boards/mega2560.h
+MCU = atmega2560
+F_CPU = 16000000UL
+RAM_SIZE = 8192 # bytes of SRAM, for the RAM report
+
+PROGRAMMER_TYPE = wiring
+
+## Mega 2560 default values
+LFUSE = 0x62
+HFUSE = 0x99
+EFUSE = 0xff
@@ -0,0 +1,11 @@
+# ATmega328P at 16MHz (Arduino Uno), pins in include/boards/uno.h
+MCU = atmega328p
+F_CPU = 16000000UL
+RAM_SIZE = 2048 # bytes of SRAM, for the RAM report
+
+PROGRAMMER_TYPE = arduino
+
+## Mega 48, 88, 168, 328 default values
+LFUSE = 0x62
+HFUSE = 0xdf
+EFUSE = 0x00
@@ -6,4 +6,8 @@
 void adcInit();
 uint16_t adcRead(uint8_t ch);
 
+// read a channel from an ISR, even while adcRead() is converting (its
+// conversion is run again), takes up to 4 conversions
+uint16_t adcReadIsr(uint8_t ch);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef BACKLIGHT_H
+#define BACKLIGHT_H
+
+#include "board.h"
+#include "lcd.h"
+#include "wheel.h"
+#include "zone.h"
+#include <inttypes.h>
+
+#define BACKLIGHT_CHANNEL BOARD_BACKLIGHT_CHANNEL // pwm channel
+#define BACKLIGHT_FULL 255                        // duty cycle while in use
+#define BACKLIGHT_DIM 32                          // duty cycle after fading
+#define BACKLIGHT_FADE_STEP 4                     // duty lost per tick fading
+#define BACKLIGHT_FADE_TIME 30                    // idle seconds before fading
+#define BACKLIGHT_OFF_TIME 120                    // idle seconds before off
+#define BACKLIGHT_TICK 10                         // ms per tick
+#define BACKLIGHT_TICKS (1000 / BACKLIGHT_TICK)   // ticks per second
+
+// the backlight is only dimmed when no zone drives its fan from its channel,
+// otherwise the display is just switched off after BACKLIGHT_OFF_TIME
+#define ZONE_ON_BACKLIGHT(sensor, fan) || (fan == BACKLIGHT_CHANNEL)
+#if !(0 ZONE_TABLE(ZONE_ON_BACKLIGHT))
+#define BACKLIGHT_PWM
+#endif
+
+typedef enum { LIGHT_ON, LIGHT_FADE, LIGHT_DIM, LIGHT_OFF } Backlight;
+
+// turn the backlight on (timer 2 pwm must be initialized) and start ticking
+void backlightInit();
+
+// count idle time and fade the backlight, every BACKLIGHT_TICK ms
+void backlightTick();
+
+// user activity, called from the keypad interrupt. the backlight comes back
+// at once, returns 1 if the display was off (the key only wakes it up)
+uint8_t backlightWake();
+
+// switch the display off or back on to follow the idle state, called from
+// the main context so it never interrupts another LCD transfer. DDRAM is
+// kept while the display is off so there's nothing to repaint
+void backlightUpdate(LCD *lcd);
+
+// 1 if the display is off and there's no point in drawing
+uint8_t backlightAsleep();
+
+#endif
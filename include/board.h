@@ -0,0 +1,20 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+// The board descriptor picked with `make BOARD=<board>`: pins, ADC channels,
+// PWM channels, zones and buffer sizes (include/boards/<board>.h). The MCU
+// and the clock come from boards/<board>.mk. The drivers derive everything
+// else from it at compile time. The registers are only named here, so the
+// host tools can include it for the zone count.
+
+#ifndef BOARD_HEADER
+#define BOARD_HEADER "boards/uno.h"
+#endif
+#include BOARD_HEADER
+
+#define BOARD_PWM_PLUS_ONE(channel, ocr, ddr, bit) +1
+
+// no. of fan PWM channels
+#define BOARD_PWM_COUNT (0 BOARD_PWM_TABLE(BOARD_PWM_PLUS_ONE))
+
+#endif
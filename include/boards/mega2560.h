@@ -0,0 +1,59 @@
+#ifndef BOARDS_MEGA2560_H
+#define BOARDS_MEGA2560_H
+
+// ATmega2560 at 16MHz (Arduino Mega 2560), four zones and bigger buffers
+
+// LCD in 4-bit mode: RS on pin 53, EN on 52, D4-D7 on pins 26-29
+#define BOARD_LCD_CTRL_PORT PORTB
+#define BOARD_LCD_CTRL_DDR DDRB
+#define BOARD_LCD_RS DDB0
+#define BOARD_LCD_EN DDB1
+#define BOARD_LCD_DATA_PORT PORTA
+#define BOARD_LCD_DATA_DDR DDRA
+#define BOARD_LCD_D4 DDA4
+#define BOARD_LCD_D5 DDA5
+#define BOARD_LCD_D6 DDA6
+#define BOARD_LCD_D7 DDA7
+
+// keypad ladder on ADC8 (A8, PK0), the only analog pins with pin change
+// interrupts; channels 8-15 are selected with MUX5 (bit 5)
+#define BOARD_KEYPAD_ADC 0x20
+#define BOARD_KEYPAD_PIN PINK
+#define BOARD_KEYPAD_BIT PINK0
+#define BOARD_KEYPAD_PCIE PCIE2
+#define BOARD_KEYPAD_PCMSK PCMSK2
+#define BOARD_KEYPAD_PCINT PCINT16
+#define BOARD_KEYPAD_VECT PCINT2_vect
+
+#define BOARD_ADC_BANDGAP 0x1E
+
+// buzzer on pin 2, the on-board LED on pin 13
+#define BOARD_BUZZER_PORT PORTE
+#define BOARD_BUZZER_DDR DDRE
+#define BOARD_BUZZER_BIT DDE4
+#define BOARD_LED_PORT PORTB
+#define BOARD_LED_DDR DDRB
+#define BOARD_LED_BIT DDB7
+
+// PWM channels, Timer2 (pins 10, 9) and Timer4 (pins 6, 7, 8)
+#define BOARD_PWM_TABLE(X)                                                     \
+  X(0, OCR2A, DDRB, DDB4)                                                      \
+  X(1, OCR2B, DDRH, DDH6) X(2, OCR4A, DDRH, DDH3) X(3, OCR4B, DDRH, DDH4)     \
+  X(4, OCR4C, DDRH, DDH5)
+#define BOARD_PWM_TIMER4
+
+// PWM channel of the LCD backlight, pin 8, free of fans so it's dimmed
+#define BOARD_BACKLIGHT_CHANNEL 4
+
+// zones: X(sensor ADC channel, fan PWM channel), on A1-A4
+#define BOARD_ZONE_TABLE(X) X(1, 1) X(2, 0) X(3, 2) X(4, 3)
+
+// ring buffers (power of 2)
+#define BOARD_LOG_SIZE 256
+#define BOARD_UART_TX_SIZE 128
+
+// USART0 interrupts, numbered as there are four USARTs
+#define BOARD_UART_RX_VECT USART0_RX_vect
+#define BOARD_UART_UDRE_VECT USART0_UDRE_vect
+
+#endif
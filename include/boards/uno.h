@@ -0,0 +1,56 @@
+#ifndef BOARDS_UNO_H
+#define BOARDS_UNO_H
+
+// ATmega328P at 16MHz (Arduino Uno), the default board
+
+// LCD in 4-bit mode
+#define BOARD_LCD_CTRL_PORT PORTB
+#define BOARD_LCD_CTRL_DDR DDRB
+#define BOARD_LCD_RS DDB0
+#define BOARD_LCD_EN DDB1
+#define BOARD_LCD_DATA_PORT PORTD
+#define BOARD_LCD_DATA_DDR DDRD
+#define BOARD_LCD_D4 DDD4
+#define BOARD_LCD_D5 DDD5
+#define BOARD_LCD_D6 DDD6
+#define BOARD_LCD_D7 DDD7
+
+// keypad ladder on ADC0 (PC0), woken by its pin change interrupt
+#define BOARD_KEYPAD_ADC 0
+#define BOARD_KEYPAD_PIN PINC
+#define BOARD_KEYPAD_BIT PINC0
+#define BOARD_KEYPAD_PCIE PCIE1
+#define BOARD_KEYPAD_PCMSK PCMSK1
+#define BOARD_KEYPAD_PCINT PCINT8
+#define BOARD_KEYPAD_VECT PCINT1_vect
+
+// ADC multiplexer input of the 1.1V bandgap
+#define BOARD_ADC_BANDGAP 0x0E
+
+#define BOARD_BUZZER_PORT PORTD
+#define BOARD_BUZZER_DDR DDRD
+#define BOARD_BUZZER_BIT DDD2
+#define BOARD_LED_PORT PORTB
+#define BOARD_LED_DDR DDRB
+#define BOARD_LED_BIT DDB5
+
+// fan PWM channels, Timer2: X(channel, compare register, DDR, bit)
+#define BOARD_PWM_TABLE(X) X(0, OCR2A, DDRB, DDB3) X(1, OCR2B, DDRD, DDD3)
+
+// PWM channel of the LCD backlight, only dimmed if no zone's fan is on it
+// (both channels drive fans here, so the display is just switched off)
+#define BOARD_BACKLIGHT_CHANNEL 0
+
+// zones: X(sensor ADC channel, fan PWM channel), ADC2-5 are free
+// e.g. a third zone would need a PWM channel of its own
+#define BOARD_ZONE_TABLE(X) X(1, 1) X(2, 0)
+
+// ring buffers (power of 2)
+#define BOARD_LOG_SIZE 64
+#define BOARD_UART_TX_SIZE 64
+
+// USART0 interrupts
+#define BOARD_UART_RX_VECT USART_RX_vect
+#define BOARD_UART_UDRE_VECT USART_UDRE_vect
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include "main.h"
+#include <inttypes.h>
+
+typedef enum {
+  POWERON_RESET,
+  EXTERNAL_RESET,
+  BROWNOUT_RESET,
+  WATCHDOG_RESET,
+} ResetCause;
+
+// classify the last reset (MCUSR is captured and cleared before main)
+ResetCause bootResetCause();
+
+// copy runtime state into .noinit RAM and update its CRC
+void bootSave(const Vars *vars, const Zones *zones, State state);
+
+// restore runtime state from .noinit RAM, returns 0 if the CRC doesn't match
+uint8_t bootRestore(Vars *vars, Zones *zones, State *state);
+
+#endif
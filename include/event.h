@@ -0,0 +1,57 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <inttypes.h>
+
+#define EVENT_QUEUE_SIZE 16 // power of 2
+
+typedef enum {
+  EVENT_TICK,     // 1s passed (timer 1)
+  EVENT_KEY_WAKE, // key pressed, data: 1 if it only woke the display up
+  EVENT_TYPES,
+} EventType;
+
+typedef struct {
+  uint8_t type; // EventType
+  uint8_t data;
+} Event;
+
+// Single-producer/single-consumer ring of events from the ISRs to the main
+// loop. ISRs don't nest, so all of them together are the one producer and
+// only move the head, the main loop only moves the tail. Both indices are a
+// byte, so they're read and written atomically and no locking is needed.
+extern Event eventQueue[EVENT_QUEUE_SIZE];
+extern volatile uint8_t eventHead;
+extern volatile uint8_t eventTail;
+
+// events lost because the queue was full, per EventType and in total
+extern volatile uint8_t eventDropped[EVENT_TYPES];
+extern volatile uint8_t eventDroppedTotal;
+
+// queue an event (from an ISR only), returns 0 if the queue is full.
+// inline so the ISRs don't have to save the call-clobbered registers
+static inline uint8_t eventPost(uint8_t type, uint8_t data) {
+  uint8_t head = eventHead;
+  uint8_t next = (head + 1) & (EVENT_QUEUE_SIZE - 1);
+
+  if (next == eventTail) {
+    if (eventDropped[type] != UINT8_MAX) {
+      eventDropped[type]++;
+    }
+    if (eventDroppedTotal != UINT8_MAX) {
+      eventDroppedTotal++;
+    }
+    return 0;
+  }
+  eventQueue[head].type = type;
+  eventQueue[head].data = data;
+  // publish the event only after it's written
+  __asm__ __volatile__("" ::: "memory");
+  eventHead = next;
+  return 1;
+}
+
+// take the oldest event (from the main loop only), returns 0 if there's none
+uint8_t eventPoll(Event *event);
+
+#endif
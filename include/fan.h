@@ -0,0 +1,40 @@
+#ifndef FAN_H
+#define FAN_H
+
+#include "main.h"
+#include <inttypes.h>
+
+#define FAN_CURVE_POINTS 3 // (temperature, duty) points of the fan curve
+#define FAN_HYSTERESIS 2   // C a temperature has to fall to be followed
+
+typedef struct {
+  uint8_t temp; // C
+  uint8_t duty; // %
+} CurvePoint;
+
+// fan curve, temperatures in increasing order
+extern CurvePoint fanCurve[FAN_CURVE_POINTS];
+
+typedef struct {
+  uint8_t duty; // %, what the screens and the registers show
+  uint8_t pwm;  // the same as a compare value, ready to be written
+} FanStep;
+
+// output of every zone for every degree from MIN_TEMP to MAX_TEMP, compiled
+// from the curve and the zone's max speed so the control step is a single
+// read: fanTable[zone][temp - MIN_TEMP]
+extern FanStep fanTable[ZONE_COUNT][MAX_TEMP - MIN_TEMP + 1];
+
+// read the curve from EEPROM (the default curve if it isn't valid) and
+// compile it
+void fanLoad();
+
+// write the curve to EEPROM and compile it
+void fanSave();
+
+// fill fanTable from the curve: the first duty below the first point, linear
+// between the points, the last duty above the last point, all of them capped
+// at the zone's max speed. call it whenever a max speed changes
+void fanCompile();
+
+#endif
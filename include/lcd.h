@@ -41,6 +41,9 @@
 #define LCD_5x10DOTS 0x04
 #define LCD_5x8DOTS 0x00
 
+// DDRAM columns per row in 2-line mode
+#define LCD_DDRAM_COLS 40
+
 typedef struct {
   uint8_t rs_pin;       // LOW: command. HIGH: character.
   uint8_t enable_pin;   // activated by a HIGH pulse.
@@ -55,9 +58,16 @@ typedef struct {
 } LCD;
 
 // initialize LCD
+// (build with -DLCD_I2C_ADDR=<addr> to drive it through a PCF8574 I2C
+// backpack instead, the pin arguments are ignored then)
 LCD lcdInit(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5, uint8_t d6,
             uint8_t d7, uint8_t cols, uint8_t rows, uint8_t charsize);
 
+// take over an LCD that is already initialized (e.g. after a warm reset):
+// configures the pins only, the controller and DDRAM are left untouched
+LCD lcdAttach(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5, uint8_t d6,
+              uint8_t d7, uint8_t cols, uint8_t rows, uint8_t charsize);
+
 // return cursor to home (0, 0)
 void lcdHome(LCD lcd);
 
@@ -70,9 +80,24 @@ void lcdSetCursor(LCD lcd, uint8_t row, uint8_t col);
 // print an string
 void lcdPrint(LCD lcd, const char *str);
 
+// print an string stored in flash (PSTR/PROGMEM)
+void lcdPrint_P(LCD lcd, const char *str);
+
 // print a number
 void lcdPrintNum(LCD lcd, uint32_t num);
 
+// write a flash string (up to LCD_DDRAM_COLS chars) into a whole DDRAM row
+// for scrolling with lcdMarqueeStep(), returns its length
+// note: the display shift moves both rows, the other row should be blank
+uint8_t lcdMarquee(LCD lcd, uint8_t row, const char *str);
+
+// scroll the display one column to the left with a single display-shift
+// command, returns the no. of columns scrolled (0 after a full turn)
+uint8_t lcdMarqueeStep(LCD lcd);
+
+// stop scrolling and move the display back
+void lcdMarqueeStop(LCD lcd);
+
 // turn on display
 void lcdDisplayOn(LCD *lcd);
 
@@ -85,14 +110,4 @@ void sendCommand(LCD lcd, uint8_t cmd);
 // send 1 byte of data
 void sendData(LCD lcd, uint8_t data);
 
-// send 4 bits (used by sendData())
-static void write4bits(LCD lcd, uint8_t value);
-
-// pulse EN pin to let LCD know of new incoming data/command
-static void pulse(LCD lcd);
-
-// set the starting DDRAM address offset for each row of the LCD
-static void setRowOffsets(LCD *lcd, uint8_t row0, uint8_t row1, uint8_t row2,
-                          uint8_t row3);
-
 #endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include "board.h"
+#include <inttypes.h>
+
+// Binary debug log. A log site only sends the ID of its format string and
+// the raw argument values, the format strings are linked into the .logfmt
+// section, which isn't loaded into flash (`make logfmt` extracts it) and the
+// host formats the messages (tools/logdump). The ID is the string's offset
+// in the section.
+//
+// LOG_WARN("zone %u fan stuck at %u%%", zone, speed);
+//
+// arguments are 16-bit integers (%d %i %u %x %X %c), at most LOG_MAX_ARGS.
+// sites above LOG_LEVEL compile to nothing.
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_WARN
+#endif
+
+#define LOG_SIZE BOARD_LOG_SIZE // ring buffer size (power of 2)
+#define LOG_MAX_ARGS 8          // arguments per message
+
+// GCC appends "a" (allocated) to the section flags, ';' starts a comment
+// for the AVR assembler so they're dropped
+#define LOG_SECTION ".logfmt,\"\",@progbits;"
+
+// the format string is prefixed with the level letter for the host
+#define LOG(level, tag, fmt, ...)                                              \
+  do {                                                                         \
+    if (level <= LOG_LEVEL) {                                                  \
+      static const char logFormat[]                                            \
+          __attribute__((section(LOG_SECTION))) = tag fmt;                     \
+      const uint16_t logArgs[] = {__VA_ARGS__};                                \
+      _Static_assert(sizeof(logArgs) <= LOG_MAX_ARGS * sizeof(uint16_t),       \
+                     "too many log arguments");                                \
+      logWrite((uint16_t)logFormat, logArgs,                                   \
+               sizeof(logArgs) / sizeof(logArgs[0]));                          \
+    }                                                                          \
+  } while (0)
+
+#define LOG_ERROR(fmt, ...) LOG(LOG_LEVEL_ERROR, "E", fmt, __VA_ARGS__)
+#define LOG_WARN(fmt, ...) LOG(LOG_LEVEL_WARN, "W", fmt, __VA_ARGS__)
+#define LOG_INFO(fmt, ...) LOG(LOG_LEVEL_INFO, "I", fmt, __VA_ARGS__)
+#define LOG_DEBUG(fmt, ...) LOG(LOG_LEVEL_DEBUG, "D", fmt, __VA_ARGS__)
+
+// messages lost because the ring buffer was full
+extern volatile uint8_t logDropped;
+
+// queue a message as a PROTO_LOG frame (main loop and ISRs), it's dropped
+// if it doesn't fit
+void logWrite(uint16_t id, const uint16_t *args, uint8_t count);
+
+// next byte to transmit or -1 (from the UART TX ISR). a frame that's begun
+// is always finished, a new one is only begun if start is set
+int16_t logNext(uint8_t start);
+
+#endif
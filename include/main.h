@@ -1,17 +1,41 @@
 #ifndef MAIN_H
 #define MAIN_H
 
+#include "util.h"
+#include "zone.h"
 #include <inttypes.h>
 
 #define PASSWORD_LENGTH 4  // password buffer size
 #define BUFFER_SIZE 16 + 1 // text buffer size + \0
-#define MENU_ITEMS 5       // no. of menu items
 #define MAX_TEMP 50        // max temperature reported by sensor
 #define MIN_TEMP 0         // min temperature reported by sensor
 #define MAX_SPEED 100      // max motor duty cycle (%)
 #define MIN_SPEED 5        // min motor duty cycle (%)
-#define SPEED_STEP_SIZE 5  // step size for motor control
 #define TIMEOUT 10         // return to status screen if
+#define STATUS_PAGE 4      // status refreshes per zone page
+#define STATUS_REFRESH 500 // status screen refresh period (ms)
+#define CONTROL_PERIOD 500 // motor control period (ms)
+#define KEY_POLL 100       // keypad polling period (ms)
+#define MARQUEE_STEP 300   // ms per scrolled column
+#define OVER_TEMP 45       // warn at or above this temperature (C)
+#define ALARM_REPEATS 3    // times the alarm rings, ALARM_SNOOZE apart
+#define ALARM_SNOOZE 300   // seconds from a snooze or ring out to the next
+
+// EEPROM layout
+#define EEPROM_MAX_SPEED 0x00 // zones.maxSpeed[0] (1 byte)
+#define EEPROM_THRESHOLD 0x01 // zones.tempThreshold[0] (1 byte)
+#define EEPROM_TIME 0x02      // vars.time (3 bytes)
+#define EEPROM_ALARM 0x05     // vars.alarm (3 bytes)
+#define EEPROM_PASSWORD 0x08  // vars.password (5 bytes)
+#define EEPROM_ZONES 0x0D     // max speed, threshold of zone 2.. (2 bytes each)
+#define EEPROM_FAN_CURVE 0x20 // fanCurve (FAN_CURVE_POINTS * 2 bytes)
+#define EEPROM_CHECKPOINT 0x30 // Checkpoint written on power failure
+
+// EEPROM address of a zone's max speed and threshold
+#define EEPROM_ZONE_MAX_SPEED(z)                                               \
+  ((z) ? EEPROM_ZONES + 2 * ((z) - 1) : EEPROM_MAX_SPEED)
+#define EEPROM_ZONE_THRESHOLD(z)                                               \
+  ((z) ? EEPROM_ZONES + 2 * ((z) - 1) + 1 : EEPROM_THRESHOLD)
 
 typedef enum {
   NOSTATE,
@@ -23,44 +47,39 @@ typedef enum {
   CHANGE_SPEED,
   CHANGE_TIME,
   SET_ALARM,
+  STATS,
+  CHANGE_CURVE,
 } State;
 
 typedef struct {
-  uint8_t currentTemp;
-  uint8_t lastTemp;
-  int8_t tempDiff;
-  uint8_t motorOn;
-  uint8_t speed;
-  uint8_t maxSpeed;
   char password[PASSWORD_LENGTH + 1];
-  uint8_t tempThreshold;
   uint8_t time[3];
   uint8_t alarm[3];
 } Vars;
 
-char menu[MENU_ITEMS][BUFFER_SIZE] = {
-    // +1 is for '\0' null terminator
-    "1.Change Pass", "2.Temp Thresh", "3.Motor Speed",
-    "4.Set Time",    "5.Set Alarm",
-};
-
 // init core system components
 void systemInit();
 
-// read temperature from sensor and adjust the motor
+// read temperature from the sensors and adjust the motor of every zone
 void motorControl();
 
 // show status screen
 void displayStatus();
 
+// draw the status screen if it's the current one (refreshTimer)
+void drawStatus();
+
 // get and validate password
 void passwordHandler();
 
-// show failure screen
-void displayFailure(char *msg);
+// show failure screen (msg is a flash string)
+void displayFailure(const char *msg);
+
+// show success screen (msg is a flash string)
+void displaySuccess(const char *msg);
 
-// show success screen
-void displaySuccess(char *msg);
+// show a message for a second, scroll it if it's longer than a row
+void displayMessage(const char *msg);
 
 // change password
 void changePassword();
@@ -77,10 +96,53 @@ void changeSpeed();
 // change temp
 void changeTemp();
 
+// edit the points of the fan curve
+void changeCurve();
+
+// print a point of the fan curve with a cursor on the temperature (field 0)
+// or the duty (field 1)
+void drawCurvePoint(uint8_t point, uint8_t temp, uint8_t duty, uint8_t field);
+
+// print a zone setting on the first row (fmt is a flash string)
+void printZoneSetting(uint8_t zone, const char *fmt, uint8_t value);
+
+// show min/avg/max of temperature and fan duty, UP/DOWN switch windows
+void displayStats();
+
+// draw the statistics of one window (StatsWindow)
+void drawStats(uint8_t window);
+
 // dispaly menu
 void displayMenu();
 
-// check if the alarm has went off
+// leave the menu for the status screen
+void lock();
+
+// background work, called from the main loop and while waiting
+void service();
+
+// wait for ms without blocking the background work
+void waitMs(uint16_t ms);
+
+// waitTimer callback
+void waitOver();
+
+// (re)start the screen timeout
+void armTimeout();
+
+// timeoutTimer callback
+void timedOut();
+
+// handle the events queued by the ISRs
+void handleEvents();
+
+// advance the clock and the screen timeout, once a second
+void secondTick();
+
+// read the keypad and pace the input loops (KEY_POLL)
+Input readKey();
+
+// ring the alarm at the alarm time and after snoozing, once a second
 void checkAlarm();
 
 // configure timer 1 to generate an interrput every 1s
@@ -92,4 +154,5 @@ void startTimer();
 // stop counting (timer 1)
 void stopTimer();
 
+
 #endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef MENU_H
+#define MENU_H
+
+#include "lcd.h"
+#include "util.h"
+#include <inttypes.h>
+
+#define MENU_COLS 16                    // LCD columns
+#define MENU_ROWS 2                     // LCD rows
+#define MENU_LABEL_SIZE (MENU_COLS - 1) // the last 2 columns hold the cursor
+#define MENU_DEPTH 3                    // max. nesting of submenus
+
+typedef enum { NODE_SUBMENU, NODE_ACTION, NODE_EDITOR } NodeType;
+
+typedef enum { MENU_NONE, MENU_EXIT, MENU_EDIT, MENU_DONE } MenuEvent;
+
+// a menu entry, menus are arrays of these in flash and never change
+typedef struct MenuNode {
+  char label[MENU_LABEL_SIZE];
+  uint8_t type;  // NodeType
+  uint8_t count; // no. of children (submenu)
+  union {
+    const struct MenuNode *children; // submenu
+    void (*action)();                // action, runs in place
+    uint8_t state;                   // editor, state of the editing screen
+  };
+} MenuNode;
+
+#define MENU_SIZE(nodes) (sizeof(nodes) / sizeof((nodes)[0]))
+#define MENU_SUBMENU(label, nodes)                                             \
+  { label, NODE_SUBMENU, MENU_SIZE(nodes), {.children = nodes } }
+#define MENU_ACTION(label, function)                                           \
+  { label, NODE_ACTION, 0, {.action = function } }
+#define MENU_EDITOR(label, editor)                                             \
+  { label, NODE_EDITOR, 0, {.state = editor } }
+
+// start at the top of a menu (nodes in flash)
+void menuOpen(const MenuNode *nodes, uint8_t count);
+
+// 1 once menuOpen() has been called
+uint8_t menuIsOpen();
+
+// draw the current level with its cursor
+void menuDraw(LCD lcd);
+
+// handle a key: UP/DOWN move the cursor, ENTER opens a submenu, runs an action
+// (MENU_DONE) or returns an editor's state (MENU_EDIT), BACK leaves a
+// submenu or the menu (MENU_EXIT), only BACK works while nothing is open
+MenuEvent menuKey(LCD lcd, Input key, uint8_t *state);
+
+#endif
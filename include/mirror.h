@@ -0,0 +1,25 @@
+#ifndef MIRROR_H
+#define MIRROR_H
+
+#include "lcd.h"
+#include "proto.h"
+#include <inttypes.h>
+
+// LCD mirror (build with -DLCD_MIRROR): lcd.c passes every command and
+// character it sends to the controller through here, a copy of the DDRAM
+// is kept and the cells that changed are streamed as PROTO_LCD frames
+
+#define MIRROR_CELLS (PROTO_LCD_ROWS * PROTO_LCD_COLS)
+#define MIRROR_PERIOD 100  // ms between updates
+#define MIRROR_KEYFRAME 50 // updates between full refreshes (5s)
+
+// start streaming, the first update is a full refresh
+void mirrorInit();
+
+// track a command sent to the controller
+void mirrorCommand(uint8_t cmd);
+
+// track a character written to the DDRAM
+void mirrorData(uint8_t data);
+
+#endif
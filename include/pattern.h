@@ -0,0 +1,46 @@
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include <inttypes.h>
+
+// outputs (active buzzer and LED, pins in include/boards/)
+#define PATTERN_BUZZER 0x01
+#define PATTERN_LED 0x02
+
+#define PATTERN_TICK 10 // ms per unit of Step.time
+
+// in increasing priority, a pattern preempts the ones before it
+typedef enum {
+  PATTERN_CLICK,    // key click
+  PATTERN_ERROR,    // wrong password
+  PATTERN_TREND,    // a zone is heading for OVER_TEMP, until stopped
+  PATTERN_OVERTEMP, // a zone is too hot, until stopped
+  PATTERN_ALARM,    // alarm clock
+  PATTERNS,
+} Pattern;
+
+typedef struct {
+  uint8_t outputs; // PATTERN_BUZZER/PATTERN_LED on for this step
+  uint8_t time;    // PATTERN_TICK units, 0 ends the pattern
+} Step;
+
+typedef struct {
+  const Step *steps; // in flash
+  uint8_t repeat;    // times to play the steps, 0 until stopped
+} PatternDef;
+
+// configure the output pins
+void patternInit();
+
+// request a pattern, it stops after it's been repeated or when it's stopped.
+// while something more important is playing, a pattern that plays until
+// stopped waits for its turn (and starts over), any other is dropped
+void patternPlay(Pattern pattern);
+
+// withdraw a pattern, stop it if it's playing
+void patternStop(Pattern pattern);
+
+// 1 if a pattern is requested (playing or waiting for its turn)
+uint8_t patternActive(Pattern pattern);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "main.h"
+#include <inttypes.h>
+
+#define BANDGAP_MIN_MV 1000   // internal reference, 1.0-1.2V from part to part,
+#define BANDGAP_MAX_MV 1200   // measured at boot against POWER_NOMINAL_MV
+#define POWER_NOMINAL_MV 5000 // supply at boot
+#define POWER_FAIL_MV 4400    // checkpoint when the supply drops below
+#define POWER_OK_MV 4700      // and arm again once it's back above
+#define POWER_POLL 10         // ms between supply measurements
+#define POWER_SAMPLES 2       // low measurements in a row before a checkpoint
+#define POWER_REPORT 100      // ms between checks for changes to log
+
+// time the hold-up capacitor keeps the MCU running after POWER_FAIL_MV is
+// crossed, and the worst case EEPROM write time of a byte
+#define POWER_HOLDUP_MS 60
+#define EEPROM_WRITE_US 3400
+
+// minimal runtime state saved when the power fails
+typedef struct {
+  uint8_t time[3];
+  uint8_t state;
+  uint8_t speed[ZONE_COUNT];
+  uint16_t crc;
+} Checkpoint;
+
+// calibrate the bandgap and start watching the supply voltage from the
+// Timer0 compare B interrupt, whatever the main loop is doing (ADC and Timer0
+// must be initialized)
+void powerInit();
+
+// 1 from the checkpoint until the supply is back above POWER_OK_MV, the fans
+// must stay off
+uint8_t powerLow();
+
+// restore the clock, the fan speeds and the UI state of the last checkpoint
+// and invalidate it, returns 0 if there's no valid checkpoint
+uint8_t powerRestore(Vars *vars, Zones *zones, State *state);
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef PROTO_H
+#define PROTO_H
+
+#include "zone.h"
+#include <inttypes.h>
+
+// Serial command protocol (shared with the host tools)
+//
+// frame:    SOF | len | cmd | payload[len] | crc lo | crc hi
+// crc:      CRC-16/CCITT (avr-libc _crc_ccitt_update, init 0xFFFF)
+//           over len, cmd and payload
+//
+// READ:     payload = reg... -> READ_REPLY, payload = value...
+// WRITE:    payload = (reg, value)... -> WRITE_REPLY, no payload
+//           all values are validated before any of them is applied
+// errors:   ERROR_REPLY, payload = error code, index of the offending byte
+//
+// LCD:      sent unprompted while the LCD mirror is on (-DLCD_MIRROR),
+//           payload = shift, control, (cell, count, char[count])...
+//           shift is the no. of columns the display is scrolled left by,
+//           control the LCD_DISPLAYCONTROL flags, cell = row *
+//           PROTO_LCD_COLS + col of the first of count changed characters
+//           (a frame without cells only updates shift and control)
+// LOG:      sent unprompted by the debug log (include/log.h),
+//           payload = format ID lo, hi, (arg lo, arg hi)...
+// TRACE:    sent unprompted while recording (-DTRACE_RECORD),
+//           payload = trace records (include/trace.h)
+
+#define PROTO_SOF 0x7E
+#define PROTO_MAX_PAYLOAD 32
+
+// commands
+#define PROTO_READ 0x01
+#define PROTO_WRITE 0x02
+#define PROTO_LCD 0x10
+#define PROTO_LOG 0x11
+#define PROTO_TRACE 0x12
+#define PROTO_REPLY 0x80 // OR'ed into the command of a reply
+#define PROTO_ERROR 0xFF
+
+// LCD mirror geometry (the whole DDRAM, not just the visible window)
+#define PROTO_LCD_ROWS 2
+#define PROTO_LCD_COLS 40
+
+// error codes
+#define PROTO_ERR_CRC 0x01
+#define PROTO_ERR_CMD 0x02
+#define PROTO_ERR_LENGTH 0x03
+#define PROTO_ERR_REG 0x04
+#define PROTO_ERR_ACCESS 0x05
+#define PROTO_ERR_VALUE 0x06
+
+// register map (REG_TEMP .. REG_THRESHOLD belong to the first zone)
+typedef enum {
+  REG_TEMP,       // current temperature (C), read-only
+  REG_MOTOR_ON,   // motor on/off, read-only
+  REG_SPEED,      // current motor speed (%), read-only
+  REG_STATE,      // UI state, read-only
+  REG_MAX_SPEED,  // max motor speed (%), EEPROM
+  REG_THRESHOLD,  // temperature threshold (C), EEPROM
+  REG_TIME_H,     // clock hours, EEPROM
+  REG_TIME_M,     // clock minutes, EEPROM
+  REG_TIME_S,     // clock seconds, EEPROM
+  REG_ALARM_H,    // alarm hours, EEPROM
+  REG_ALARM_M,    // alarm minutes, EEPROM
+  REG_ALARM_S,    // alarm seconds, EEPROM
+  REG_PASSWORD_0, // password digits ('1' or '2'), EEPROM, write-only
+  REG_PASSWORD_1,
+  REG_PASSWORD_2,
+  REG_PASSWORD_3,
+  REG_EVENTS_DROPPED, // ISR events lost to a full queue, read-only
+  REG_ZONES, // the other zones follow in blocks of ZONE_REGS registers
+} Register;
+
+// registers of zone z (z >= 1): REG_ZONES + (z - 1) * ZONE_REGS + ZoneRegister
+typedef enum {
+  ZONE_REG_TEMP,
+  ZONE_REG_MOTOR_ON,
+  ZONE_REG_SPEED,
+  ZONE_REG_MAX_SPEED,
+  ZONE_REG_THRESHOLD,
+  ZONE_REGS,
+} ZoneRegister;
+
+// no. of registers
+#define REG_COUNT (REG_ZONES + (ZONE_COUNT - 1) * ZONE_REGS)
+
+// feed one received byte to the frame parser (called from the RX ISR)
+void protoReceive(uint8_t byte);
+
+// execute a pending request and send the reply (called from the main loop)
+void protoPoll();
+
+// send a frame (called from the main loop)
+void protoSend(uint8_t cmd, const uint8_t *data, uint8_t len);
+
+#endif
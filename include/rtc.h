@@ -0,0 +1,15 @@
+#ifndef RTC_H
+#define RTC_H
+
+#include <inttypes.h>
+
+#define RTC_ADDR 0x68 // DS1307/DS3231 I2C address
+
+// start reading the time (h, m, s) from the RTC, time is updated from the
+// TWI ISR once the transaction is done
+void rtcRead(uint8_t *time);
+
+// write the time (h, m, s) to the RTC (and start its oscillator)
+void rtcWrite(const uint8_t *time);
+
+#endif
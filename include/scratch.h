@@ -0,0 +1,55 @@
+#ifndef SCRATCH_H
+#define SCRATCH_H
+
+#include "fan.h"
+#include "main.h"
+#include <inttypes.h>
+
+#define SCRATCH_BUDGET 32 // bytes of RAM shared by all the screens
+
+// working state of the screens, only one of them is active at a time
+typedef struct {
+  uint8_t zone;    // zone shown
+  uint8_t refresh; // refreshes since the last page flip
+} StatusScratch;
+
+typedef struct {
+  char entered[PASSWORD_LENGTH + 1]; // digits entered so far
+} PassScratch;
+
+typedef struct {
+  uint8_t time[3]; // time or alarm being edited
+} ClockScratch;
+
+typedef struct {
+  uint8_t value; // max speed or threshold being edited
+} ZoneScratch;
+
+typedef struct {
+  CurvePoint curve[FAN_CURVE_POINTS]; // copy being edited
+  uint8_t field;                      // point * 2, +1 for the duty
+} CurveScratch;
+
+typedef struct {
+  uint8_t window;  // StatsWindow shown
+  uint8_t refresh; // key polls since the last redraw
+} StatsScratch;
+
+typedef struct {
+  char line[BUFFER_SIZE]; // text of one row, shared by all the screens
+  union {
+    StatusScratch status;
+    PassScratch pass;
+    ClockScratch clock;
+    ZoneScratch zone;
+    CurveScratch curve;
+    StatsScratch stats;
+  };
+} Scratch;
+
+extern Scratch scratch;
+
+// zero the scratch, the main loop calls it before entering a screen
+void scratchReset();
+
+#endif
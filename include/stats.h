@@ -0,0 +1,33 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <inttypes.h>
+
+// Rolling min/avg/max of the temperature and fan duty of zone 1 only, over a
+// minute, an hour and a day, for the Statistics screen. The 2 series of 3
+// windows and their buckets take about 430 bytes of .bss, a fifth of the
+// ATmega328P's 2 KB, so the other zones aren't tracked. The fan controller
+// works from the trend fit of every zone (trend.h) instead.
+
+#define STATS_SLOTS 12      // slots per window
+#define STATS_SAMPLE_TIME 5 // seconds per sample (minute window slot)
+#define STATS_HOUR_BUCKET 60 // samples per hour window slot (5 minutes)
+#define STATS_DAY_BUCKET 24  // hour window slots per day window slot (2 hours)
+
+typedef enum { STATS_TEMP, STATS_DUTY, STATS_SERIES } StatsSeries;
+
+typedef enum { STATS_MINUTE, STATS_HOUR, STATS_DAY, STATS_WINDOWS } StatsWindow;
+
+typedef struct {
+  uint8_t min;
+  uint8_t avg;
+  uint8_t max;
+} Summary;
+
+// feed the current temperature (C) and fan duty (%), called once a second
+void statsSample(uint8_t temp, uint8_t duty);
+
+// min/avg/max of a series over a window, returns 0 if there's no data yet
+uint8_t statsGet(StatsSeries series, StatsWindow window, Summary *out);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <inttypes.h>
+
+// Input trace. Built with -DTRACE_RECORD, the firmware sends the settings,
+// the ADC samples and the keypad interrupts it sees as PROTO_TRACE frames,
+// tools/tracecap saves them to a file and the harness in replay/ feeds it
+// back to a host build of the firmware (-DTRACE_REPLAY).
+//
+// A trace is a stream of 3-byte records, dt is the time in ms since the
+// previous record:
+//
+// ADC:    0x00 | ch, value lo, value hi << 6 | dt  (only when it changed)
+// key:    0x10, 0, dt                              (keypad interrupt)
+// EEPROM: 0x20, address, value                     (settings, first)
+// delay:  0x30, dt lo, dt hi                       (dt > TRACE_DT_MAX)
+
+#define TRACE_ADC 0x00
+#define TRACE_KEY 0x10
+#define TRACE_EEPROM 0x20
+#define TRACE_DELAY 0x30
+#define TRACE_KIND 0xF0   // record kind bits of the first byte
+#define TRACE_DT_MAX 0x3F // longest dt within a record
+
+#define TRACE_RECORD_SIZE 3
+#define TRACE_CHANNELS 16    // ADC multiplexer inputs
+#define TRACE_EEPROM_SIZE 64 // settings at the start of the EEPROM
+#define TRACE_FLUSH 250      // ms between frames at most
+#define TRACE_IDLE 30000     // ms without records before a delay record
+
+// save the settings before anything changes them (first thing at boot)
+void traceInit();
+
+// send the settings and start recording (interrupts must be enabled)
+void traceStart();
+
+// record an ADC conversion
+void traceAdc(uint8_t channel, uint16_t value);
+
+// record a keypad interrupt
+void traceKey();
+
+// the ADC result to replay for a channel (provided by the replay harness)
+uint16_t traceReplayAdc(uint8_t channel);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef TREND_H
+#define TREND_H
+
+#include "main.h"
+#include <inttypes.h>
+
+// Temperature trend of every zone: a least-squares line through the last
+// TREND_WINDOW samples. The sums of the fit are updated as a sample enters
+// and the oldest one leaves, so a sample is O(1) whatever the window.
+
+#define TREND_WINDOW 16    // samples in the fit
+#define TREND_PERIOD 4     // control steps per sample (2s)
+#ifndef TREND_LEAD
+#define TREND_LEAD 15 // samples the fans look ahead while rising (30s)
+#endif
+#define TREND_WARN_AHEAD 5 // minutes, warn when OVER_TEMP is due this soon
+
+// samples in TREND_WARN_AHEAD minutes
+#define TREND_WARN_SAMPLES                                                     \
+  (TREND_WARN_AHEAD * 60000UL / (CONTROL_PERIOD * TREND_PERIOD))
+
+// feed the zone temperatures (C), called every control step
+void trendSample(const uint8_t *temps);
+
+// rise (C) the fit projects over the next samples, 0 unless rising
+uint8_t trendRise(uint8_t zone, uint16_t samples);
+
+// slope of the fit, 1/256 C per sample
+int16_t trendSlope(uint8_t zone);
+
+#endif
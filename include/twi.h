@@ -0,0 +1,37 @@
+#ifndef TWI_H
+#define TWI_H
+
+#include <inttypes.h>
+
+#define TWI_FREQ 100000UL // SCL frequency (Hz)
+#define TWI_QUEUE_SIZE 4  // no. of queued transactions (power of 2)
+
+// transaction status passed to the done() callback
+#define TWI_OK 0
+#define TWI_ERROR 1 // NACK or lost arbitration
+
+// write txLength bytes, then read rxLength bytes after a repeated start
+// (either length may be 0). The buffers must stay valid until done() is
+// called, done() runs in the TWI ISR and may be 0.
+typedef struct {
+  uint8_t address; // 7-bit slave address
+  const uint8_t *txData;
+  uint8_t txLength;
+  uint8_t *rxData;
+  uint8_t rxLength;
+  void (*done)(uint8_t status);
+} TwiTransaction;
+
+// init TWI master at TWI_FREQ
+void twiInit();
+
+// queue a transaction, returns 0 if the queue is full
+uint8_t twiSubmit(const TwiTransaction *t);
+
+// check if any transaction is queued or in progress
+uint8_t twiBusy();
+
+// wait until all queued transactions are done
+void twiFlush();
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef UART_H
+#define UART_H
+
+#include "board.h"
+#include <inttypes.h>
+
+#define UART_TX_SIZE BOARD_UART_TX_SIZE // TX ring buffer size (power of 2)
+
+// init USART0 at BAUD, 8N1, RX and TX interrupt driven
+void uartInit();
+
+// queue bytes for transmission (waits while the TX buffer is full), a
+// frame must be queued with a single call so log frames don't cut into it
+void uartWrite(const uint8_t *data, uint8_t len);
+
+// no. of bytes uartWrite() can queue without waiting
+uint8_t uartFree();
+
+// make sure the TX ISR runs, e.g. for a new log frame
+void uartKick();
+
+#endif
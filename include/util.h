@@ -21,4 +21,7 @@ void pmwInit();
 
 void pwmSetDuty(uint8_t channel, uint8_t duty_cycle);
 
+// duty cycle (%) to a pwm compare value, (p * 255 / 100) without a division
+#define PERCENT_TO_PWM(p) ((uint8_t)(((uint16_t)(p) * 653) >> 8))
+
 #endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef WHEEL_H
+#define WHEEL_H
+
+#include <inttypes.h>
+
+#define WHEEL_SLOTS 64 // slots (ms) per turn of the wheel, power of 2
+#define WHEEL_SHIFT 6  // log2(WHEEL_SLOTS)
+
+// Hashed timer wheel on a 1ms tick. A timer due in t ms sits in slot
+// (now + t) % WHEEL_SLOTS with the no. of whole turns left, so arming and
+// cancelling are O(1) list operations and every tick only looks at the
+// timers of one slot. The tick interrupt just counts, timers expire and
+// their callbacks run from wheelRun() in the main context.
+
+typedef struct Timer {
+  struct Timer *next;
+  struct Timer *prev;
+  struct Timer **list; // list the timer is on, NULL if it's not armed
+  void (*callback)();
+  uint16_t period; // ms, 0 for a one-shot timer
+  uint16_t rounds; // turns of the wheel left
+} Timer;
+
+// configure timer 0 to generate an interrupt every 1ms
+void wheelInit();
+
+// expire the timers due since the last call and run their callbacks
+void wheelRun();
+
+// ms since wheelInit(), wraps around
+uint16_t wheelNow();
+
+// (re)arm a timer to fire in ms (1-65535) and then every period ms, or only
+// once if period is 0
+void timerArm(Timer *timer, uint16_t ms, uint16_t period, void (*callback)());
+
+// disarm a timer, does nothing if it isn't armed
+void timerCancel(Timer *timer);
+
+// 1 if the timer is armed
+uint8_t timerArmed(const Timer *timer);
+
+#endif
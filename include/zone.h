@@ -0,0 +1,31 @@
+#ifndef ZONE_H
+#define ZONE_H
+
+#include "board.h"
+#include <inttypes.h>
+
+// Zone table, one line per zone: X(sensor ADC channel, fan PWM channel)
+// set by the board descriptor (include/boards/), the bench overrides it
+#ifndef ZONE_TABLE
+#define ZONE_TABLE(X) BOARD_ZONE_TABLE(X)
+#endif
+
+#define ZONE_PLUS_ONE(sensor, fan) +1
+#define ZONE_SENSOR(sensor, fan) sensor,
+#define ZONE_FAN(sensor, fan) fan,
+
+// no. of zones
+#define ZONE_COUNT (0 ZONE_TABLE(ZONE_PLUS_ONE))
+
+// zone state, one array per field so the control step sweeps each of
+// them with a tight loop
+typedef struct {
+  uint8_t currentTemp[ZONE_COUNT];
+  uint8_t curveTemp[ZONE_COUNT]; // temperature the fan curve is read at
+  uint8_t motorOn[ZONE_COUNT];
+  uint8_t speed[ZONE_COUNT];
+  uint8_t maxSpeed[ZONE_COUNT];
+  uint8_t tempThreshold[ZONE_COUNT];
+} Zones;
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef REPLAY_AVR_EEPROM_H
+#define REPLAY_AVR_EEPROM_H
+
+// Host stand-in for <avr/eeprom.h>, the EEPROM is an array in board.c
+// filled in by the harness
+
+#include <stddef.h>
+#include <inttypes.h>
+
+uint8_t eeprom_read_byte(const uint8_t *addr);
+void eeprom_write_byte(uint8_t *addr, uint8_t value);
+void eeprom_update_byte(uint8_t *addr, uint8_t value);
+void eeprom_read_block(void *dst, const void *src, size_t size);
+void eeprom_write_block(const void *src, void *dst, size_t size);
+void eeprom_update_block(const void *src, void *dst, size_t size);
+
+// writes finish at once
+#define eeprom_busy_wait()
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef REPLAY_AVR_INTERRUPT_H
+#define REPLAY_AVR_INTERRUPT_H
+
+// Host stand-in for <avr/interrupt.h>: an ISR is a plain function named
+// after its vector, the harness calls it when the interrupt would fire
+
+#define ISR(vector, ...) void vector(void)
+#define sei()
+#define cli()
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef REPLAY_AVR_IO_H
+#define REPLAY_AVR_IO_H
+
+// Host stand-in for <avr/io.h>: the I/O registers are plain variables
+// (defined in board.c), the bit numbers are the ATmega328P's
+
+#include <inttypes.h>
+
+#define REPLAY_REGISTERS(R8, R16)                                              \
+  R8(PINB) R8(DDRB) R8(PORTB) R8(PINC) R8(DDRC) R8(PORTC) R8(PIND) R8(DDRD)    \
+  R8(PORTD) R8(MCUSR) R8(SREG) R8(PCICR) R8(PCMSK0) R8(PCMSK1) R8(PCMSK2)      \
+  R8(ADMUX) R8(ADCSRA) R8(ADCSRB) R8(DIDR0) R16(ADC) R8(TCCR0A) R8(TCCR0B)     \
+  R8(TCNT0) R8(OCR0A) R8(OCR0B) R8(TIMSK0) R8(TCCR1A) R8(TCCR1B) R8(TCCR1C)    \
+  R16(TCNT1) R16(OCR1A) R16(OCR1B) R8(TIMSK1) R8(TCCR2A) R8(TCCR2B) R8(TCNT2)  \
+  R8(OCR2A) R8(OCR2B) R8(TIMSK2) R8(UCSR0A) R8(UCSR0B) R8(UCSR0C) R8(UBRR0H)   \
+  R8(UBRR0L) R8(UDR0) R8(TWBR) R8(TWSR) R8(TWAR) R8(TWDR) R8(TWCR) R16(EEAR)   \
+  R8(EEDR)
+
+#define REPLAY_EXTERN8(reg) extern volatile uint8_t reg;
+#define REPLAY_EXTERN16(reg) extern volatile uint16_t reg;
+REPLAY_REGISTERS(REPLAY_EXTERN8, REPLAY_EXTERN16)
+
+// ports
+enum { PINB0, PINB1, PINB2, PINB3, PINB4, PINB5, PINB6, PINB7 };
+enum { DDB0, DDB1, DDB2, DDB3, DDB4, DDB5, DDB6, DDB7 };
+enum { PORTB0, PORTB1, PORTB2, PORTB3, PORTB4, PORTB5, PORTB6, PORTB7 };
+enum { PINC0, PINC1, PINC2, PINC3, PINC4, PINC5, PINC6 };
+enum { DDC0, DDC1, DDC2, DDC3, DDC4, DDC5, DDC6 };
+enum { PORTC0, PORTC1, PORTC2, PORTC3, PORTC4, PORTC5, PORTC6 };
+enum { PIND0, PIND1, PIND2, PIND3, PIND4, PIND5, PIND6, PIND7 };
+enum { DDD0, DDD1, DDD2, DDD3, DDD4, DDD5, DDD6, DDD7 };
+enum { PORTD0, PORTD1, PORTD2, PORTD3, PORTD4, PORTD5, PORTD6, PORTD7 };
+
+// reset and pin change interrupts
+enum { PORF, EXTRF, BORF, WDRF };
+enum { PCIE0, PCIE1, PCIE2 };
+enum { PCINT8, PCINT9, PCINT10, PCINT11, PCINT12, PCINT13, PCINT14 };
+
+// ADC
+enum { MUX0, MUX1, MUX2, MUX3, ADLAR = 5, REFS0, REFS1 };
+enum { ADPS0, ADPS1, ADPS2, ADIE, ADIF, ADATE, ADSC, ADEN };
+
+// timers
+enum { WGM00, WGM01, COM0B0 = 4, COM0B1, COM0A0, COM0A1 };
+enum { CS00, CS01, CS02, WGM02 };
+enum { TOIE0, OCIE0A, OCIE0B };
+enum { WGM10, WGM11, COM1B0 = 4, COM1B1, COM1A0, COM1A1 };
+enum { CS10, CS11, CS12, WGM12, WGM13 };
+enum { TOIE1, OCIE1A, OCIE1B };
+enum { WGM20, WGM21, COM2B0 = 4, COM2B1, COM2A0, COM2A1 };
+enum { CS20, CS21, CS22, WGM22 };
+enum { TOIE2, OCIE2A, OCIE2B };
+
+// USART
+enum { MPCM0, U2X0, UPE0, DOR0, FE0, UDRE0, TXC0, RXC0 };
+enum { TXB80, RXB80, UCSZ02, TXEN0, RXEN0, UDRIE0, TXCIE0, RXCIE0 };
+enum { UCPOL0, UCSZ00, UCSZ01, USBS0, UPM00, UPM01, UMSEL00, UMSEL01 };
+
+// TWI
+enum { TWPS0, TWPS1 };
+enum { TWIE, TWEN = 2, TWWC, TWSTO, TWSTA, TWEA, TWINT };
+
+#define E2END 0x3FF
+
+#endif
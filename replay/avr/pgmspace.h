@@ -0,0 +1,46 @@
+#ifndef REPLAY_AVR_PGMSPACE_H
+#define REPLAY_AVR_PGMSPACE_H
+
+// Host stand-in for <avr/pgmspace.h>: "flash" is ordinary memory
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(str) (str)
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+// as wide as what addr points to, the firmware keeps function pointers in
+// flash and they don't fit 16 bits on the host
+#define pgm_read_word(addr) (*(addr))
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strlen_P strlen
+
+// %S is a string in flash for avr-libc but a wide string for the host's
+// libc, the format is copied with it turned into %s
+static inline int snprintf_P(char *str, size_t size, const char *fmt, ...) {
+  char format[64];
+  va_list args;
+  int len;
+
+  snprintf(format, sizeof(format), "%s", fmt);
+  for (char *c = format; *c; c++) {
+    if (*c == '%' && c[1]) {
+      c++;
+      while (strchr("-+ #0123456789.", *c) && c[1]) {
+        c++;
+      }
+      if (*c == 'S') {
+        *c = 's';
+      }
+    }
+  }
+  va_start(args, fmt);
+  len = vsnprintf(str, size, format, args);
+  va_end(args);
+  return len;
+}
+
+#endif
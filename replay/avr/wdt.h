@@ -0,0 +1,15 @@
+#ifndef REPLAY_AVR_WDT_H
+#define REPLAY_AVR_WDT_H
+
+// Host stand-in for <avr/wdt.h>. service() kicks the watchdog once per
+// main loop pass, the harness takes that as 1ms going by
+
+#define WDTO_2S 7
+
+void replayStep();
+
+#define wdt_reset() replayStep()
+#define wdt_enable(timeout)
+#define wdt_disable()
+
+#endif
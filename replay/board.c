@@ -0,0 +1,57 @@
+#include "replay/board.h"
+#include "include/uart.h"
+#include "replay/hd44780.h"
+#include <avr/eeprom.h>
+#include <avr/io.h>
+#include <inttypes.h>
+#include <stddef.h>
+
+// the I/O registers
+#define DEFINE8(reg) volatile uint8_t reg;
+#define DEFINE16(reg) volatile uint16_t reg;
+REPLAY_REGISTERS(DEFINE8, DEFINE16)
+
+uint8_t boardEeprom[E2END + 1] = {[0 ... E2END] = 0xFF};
+
+void replayDelay(double us) {
+  hd44780Bus((BOARD_LCD_CTRL_PORT >> BOARD_LCD_RS) & 1,
+             (BOARD_LCD_CTRL_PORT >> BOARD_LCD_EN) & 1,
+             BOARD_LCD_DATA_PORT >> BOARD_LCD_D4, us * 1000);
+}
+
+// nobody listens to the USART
+void uartInit() {}
+
+void uartWrite(const uint8_t *data, uint8_t len) {}
+
+uint8_t uartFree() { return UART_TX_SIZE - 1; }
+
+void uartKick() {}
+
+uint8_t eeprom_read_byte(const uint8_t *addr) {
+  return boardEeprom[(uintptr_t)addr & E2END];
+}
+
+void eeprom_write_byte(uint8_t *addr, uint8_t value) {
+  boardEeprom[(uintptr_t)addr & E2END] = value;
+}
+
+void eeprom_update_byte(uint8_t *addr, uint8_t value) {
+  eeprom_write_byte(addr, value);
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    ((uint8_t *)dst)[i] = eeprom_read_byte((const uint8_t *)src + i);
+  }
+}
+
+void eeprom_write_block(const void *src, void *dst, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    eeprom_write_byte((uint8_t *)dst + i, ((const uint8_t *)src)[i]);
+  }
+}
+
+void eeprom_update_block(const void *src, void *dst, size_t size) {
+  eeprom_write_block(src, dst, size);
+}
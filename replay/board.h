@@ -0,0 +1,24 @@
+#ifndef REPLAY_BOARD_H
+#define REPLAY_BOARD_H
+
+// Host stand-ins for the board around the firmware, shared by the harnesses
+// (replay.c, bench/lcdbench.c): the I/O registers, the EEPROM, the USART and
+// an HD44780 (hd44780.h) on the LCD pins of the default board
+
+#include "include/board.h"
+#include "include/main.h"
+#include <avr/io.h>
+#include <inttypes.h>
+
+// contents of the EEPROM, erased until the harness fills it in
+extern uint8_t boardEeprom[E2END + 1];
+
+// the firmware, main() is built as app_main()
+int app_main();
+void TIMER0_COMPA_vect();
+void TIMER0_COMPB_vect();
+void TIMER1_COMPA_vect();
+void BOARD_KEYPAD_VECT();
+extern State currentState;
+
+#endif
@@ -0,0 +1,198 @@
+#include "hd44780.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ROW_ADDRESS 0x40 // DDRAM address of the second row
+
+Hd44780Stats hd44780Stats;
+
+static uint64_t now = 0; // ns since power-on
+static uint64_t busyUntil = HD44780_POWER_ON;
+static uint64_t rsChanged = 0;
+static uint64_t dataChanged = 0;
+static uint64_t enRose = 0;
+static uint64_t enFell = 0;
+static uint8_t rs = 0, en = 0, data = 0; // pins at the last sample
+static uint8_t strobed = 0;              // EN has been pulsed before
+static uint8_t powered = 0;              // the internal reset has run
+
+static uint8_t ddram[ROW_ADDRESS * HD44780_ROWS];
+static uint8_t cgram[HD44780_CGRAM_SIZE];
+static uint8_t address = 0;   // address counter
+static uint8_t toCgram = 0;   // data goes to CGRAM
+static uint8_t increment = 1; // entry mode I/D
+static uint8_t autoShift = 0; // entry mode S
+static uint8_t displayOn = 0;
+static uint8_t shift = 0;     // display shift, columns to the left
+static uint8_t fourBit = 0;   // interface data length
+static uint8_t initSteps = 0; // 8-bit function sets so far
+static uint8_t upper = 0;     // first nibble of the byte
+static uint8_t half = 0;      // the first nibble was latched
+
+// execute an instruction or write data
+static void execute(uint8_t isData, uint8_t value);
+
+// the DDRAM address after addr, up or down, the rows follow each other
+static uint8_t nextAddress(uint8_t addr, uint8_t up);
+
+// report a broken constraint
+static void violation(const char *what);
+
+void hd44780Bus(uint8_t newRs, uint8_t newEn, uint8_t newData, uint64_t ns) {
+  newData &= 0x0F;
+  if (!powered) {
+    // the internal reset clears the display
+    memset(ddram, ' ', sizeof(ddram));
+    powered = 1;
+  }
+
+  if (newRs != rs) {
+    if (strobed && !en && now - enFell < HD44780_H) {
+      violation("RS hold");
+    }
+    rsChanged = now;
+  }
+  if (newData != data) {
+    if (strobed && !en && now - enFell < HD44780_H) {
+      violation("data hold");
+    }
+    dataChanged = now;
+  }
+
+  if (newEn && !en) {
+    if (now - rsChanged < HD44780_AS) {
+      violation("RS set-up");
+    }
+    if (strobed && now - enRose < HD44780_CYCE) {
+      violation("EN cycle");
+    }
+    enRose = now;
+  } else if (!newEn && en) {
+    // the nibble is latched on the falling edge
+    if (now - enRose < HD44780_PWEH) {
+      violation("EN pulse width");
+    }
+    if (now - dataChanged < HD44780_DSW) {
+      violation("data set-up");
+    }
+    if (now < busyUntil) {
+      violation("busy");
+    }
+    enFell = now;
+    strobed = 1;
+    hd44780Stats.strobes++;
+    hd44780Stats.busTime += HD44780_CYCE;
+
+    if (!fourBit) {
+      // D0-D3 aren't connected and read as 0
+      execute(newRs, newData << 4);
+    } else if (!half) {
+      upper = newData;
+      half = 1;
+    } else {
+      half = 0;
+      execute(newRs, upper << 4 | newData);
+    }
+  }
+
+  rs = newRs;
+  en = newEn;
+  data = newData;
+  now += ns;
+}
+
+uint8_t hd44780Char(uint8_t row, uint8_t col) {
+  if (!displayOn || row >= HD44780_ROWS) {
+    return ' ';
+  }
+  return ddram[row * ROW_ADDRESS + (shift + col) % HD44780_COLS];
+}
+
+uint8_t hd44780Cgram(uint8_t addr) {
+  return cgram[addr % HD44780_CGRAM_SIZE];
+}
+
+static void execute(uint8_t isData, uint8_t value) {
+  uint64_t time = HD44780_EXEC;
+
+  if (isData) {
+    hd44780Stats.data++;
+    if (toCgram) {
+      cgram[address] = value;
+      address = (address + (increment ? 1 : HD44780_CGRAM_SIZE - 1)) %
+                HD44780_CGRAM_SIZE;
+    } else {
+      ddram[address] = value;
+      address = nextAddress(address, increment);
+      if (autoShift) {
+        shift = (shift + (increment ? 1 : HD44780_COLS - 1)) % HD44780_COLS;
+      }
+    }
+  } else {
+    hd44780Stats.commands++;
+    if (value & 0x80) {
+      // set DDRAM address
+      address = value & 0x7F;
+      toCgram = 0;
+    } else if (value & 0x40) {
+      // set CGRAM address
+      address = value & 0x3F;
+      toCgram = 1;
+    } else if (value & 0x20) {
+      // function set, the power-on initialization takes longer
+      if (!fourBit && initSteps < 2) {
+        time = initSteps++ ? HD44780_INIT_2 : HD44780_INIT_1;
+      }
+      fourBit = !(value & 0x10);
+    } else if (value & 0x10) {
+      // cursor or display shift
+      uint8_t right = value & 0x04;
+      if (value & 0x08) {
+        shift = (shift + (right ? HD44780_COLS - 1 : 1)) % HD44780_COLS;
+      } else {
+        address = nextAddress(address, right);
+      }
+    } else if (value & 0x08) {
+      displayOn = value & 0x04;
+    } else if (value & 0x04) {
+      increment = value & 0x02;
+      autoShift = value & 0x01;
+    } else if (value & 0x02) {
+      // return home
+      address = 0;
+      toCgram = 0;
+      shift = 0;
+      time = HD44780_EXEC_SLOW;
+    } else if (value & 0x01) {
+      // clear display
+      memset(ddram, ' ', sizeof(ddram));
+      address = 0;
+      toCgram = 0;
+      increment = 1;
+      shift = 0;
+      time = HD44780_EXEC_SLOW;
+    }
+  }
+
+  busyUntil = now + time;
+  hd44780Stats.busTime += time;
+}
+
+static uint8_t nextAddress(uint8_t addr, uint8_t up) {
+  uint8_t row = addr >= ROW_ADDRESS;
+  uint8_t col = addr - row * ROW_ADDRESS;
+
+  if (up && ++col == HD44780_COLS) {
+    col = 0;
+    row = !row;
+  } else if (!up && col-- == 0) {
+    col = HD44780_COLS - 1;
+    row = !row;
+  }
+  return row * ROW_ADDRESS + col;
+}
+
+static void violation(const char *what) {
+  hd44780Stats.violations++;
+  fprintf(stderr, "hd44780: %s at %.3fms\n", what, now / 1e6);
+}
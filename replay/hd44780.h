@@ -0,0 +1,48 @@
+#ifndef REPLAY_HD44780_H
+#define REPLAY_HD44780_H
+
+// Model of the HD44780 LCD controller for the host builds. It is fed the
+// state of RS, EN and D4-D7 whenever the firmware busy-waits, latches a
+// nibble on every falling edge of EN, keeps DDRAM and CGRAM, counts what was
+// sent and checks the bus against the datasheet timing (fosc = 270kHz)
+
+#include <inttypes.h>
+
+#define HD44780_ROWS 2  // 2-line mode
+#define HD44780_COLS 40 // DDRAM columns per row
+#define HD44780_CGRAM_SIZE 64
+
+// timing (ns)
+#define HD44780_POWER_ON 15000000 // from power-on to the first instruction
+#define HD44780_INIT_1 4100000    // after the first 8-bit function set
+#define HD44780_INIT_2 100000     // after the second one
+#define HD44780_EXEC 37000        // instructions and data writes
+#define HD44780_EXEC_SLOW 1520000 // clear display and return home
+#define HD44780_AS 40             // RS set-up before EN rises
+#define HD44780_DSW 80            // data set-up before EN falls
+#define HD44780_H 10              // RS and data hold after EN falls
+#define HD44780_PWEH 230          // EN high
+#define HD44780_CYCE 500          // EN cycle
+
+typedef struct {
+  uint32_t commands;   // instructions executed
+  uint32_t data;       // bytes written to DDRAM or CGRAM
+  uint32_t strobes;    // nibbles latched
+  uint64_t busTime;    // least time the bus needed for them (ns)
+  uint32_t violations; // timing constraints broken
+} Hd44780Stats;
+
+// counts since the harness last cleared them
+extern Hd44780Stats hd44780Stats;
+
+// the pins as they are now (data is D4-D7 in the low nibble), then ns pass
+void hd44780Bus(uint8_t rs, uint8_t en, uint8_t data, uint64_t ns);
+
+// character shown at a visible position (display shift applied), a space
+// while the display is off
+uint8_t hd44780Char(uint8_t row, uint8_t col);
+
+// a CGRAM byte, the dots of one row of a custom character
+uint8_t hd44780Cgram(uint8_t addr);
+
+#endif
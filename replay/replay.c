@@ -0,0 +1,210 @@
+// Replays an input trace (include/trace.h) through a host build of the
+// firmware and prints what it did, one line per change with the time in ms:
+//
+// 1500 state 2
+// 1500 pwm 1 153
+// 1600 lcd |Temp: 25C  Fan:1 |12:00:01        |
+//
+// usage: replay <trace> [ms]
+//
+// Every pass of the main loop (every wdt_reset()) is taken as 1ms, the
+// timer interrupts are called from here and the ADC returns the recorded
+// samples, so a run only depends on the trace and is many times faster than
+// real time. It stops 1s after the last record, or after ms if given. The
+// LCD is what the HD44780 model made of the bus, timing violations go to
+// stderr.
+
+#include "include/main.h"
+#include "include/trace.h"
+#include "replay/board.h"
+#include "replay/hd44780.h"
+#include <avr/io.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TAIL 1000       // ms to run on after the last record
+#define VISIBLE_COLS 16 // of the LCD
+#define FAN_CHANNELS BOARD_PWM_COUNT
+#define BANDGAP 225     // 1.1V with a 5V supply
+#define PWM_DUTY(channel, ocr, ddr, bit) ocr,
+
+static uint8_t *trace;   // the records
+static long traceSize;   // in bytes
+static long next = 0;    // offset of the next record
+static uint32_t due = 0; // time the next record is due
+static uint32_t now = 0; // ms since reset
+static uint32_t end = 0; // time to stop
+static uint16_t samples[TRACE_CHANNELS];
+
+// what was last printed
+static State reportedState = NOSTATE;
+static uint8_t reportedDuty[FAN_CHANNELS];
+static char reportedScreen[HD44780_ROWS * VISIBLE_COLS + 1];
+
+static void usage() {
+  fprintf(stderr, "usage: replay <trace> [ms]\n");
+  exit(2);
+}
+
+static void loadTrace(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    perror(path);
+    exit(1);
+  }
+  fseek(file, 0, SEEK_END);
+  traceSize = ftell(file) / TRACE_RECORD_SIZE * TRACE_RECORD_SIZE;
+  rewind(file);
+  trace = malloc(traceSize + 1);
+  if (!trace || fread(trace, 1, traceSize, file) != (size_t)traceSize) {
+    fprintf(stderr, "replay: can't read %s\n", path);
+    exit(1);
+  }
+  fclose(file);
+}
+
+// dt of a record
+static uint16_t recordDt(const uint8_t *r) {
+  switch (r[0] & TRACE_KIND) {
+  case TRACE_ADC:
+  case TRACE_KEY:
+    return r[2] & TRACE_DT_MAX;
+  case TRACE_DELAY:
+    return r[1] | r[2] << 8;
+  }
+  return 0;
+}
+
+// settle the EEPROM, the channels' values before their first samples and
+// when the trace ends
+static void scanTrace() {
+  uint32_t time = 0;
+
+  for (int ch = 0; ch < TRACE_CHANNELS; ch++) {
+    samples[ch] = UINT16_MAX;
+  }
+
+  for (long i = 0; i < traceSize; i += TRACE_RECORD_SIZE) {
+    const uint8_t *r = &trace[i];
+    time += recordDt(r);
+    if ((r[0] & TRACE_KIND) == TRACE_EEPROM) {
+      boardEeprom[r[1]] = r[2];
+    } else if ((r[0] & TRACE_KIND) == TRACE_ADC) {
+      uint8_t ch = r[0] & (TRACE_CHANNELS - 1);
+      if (samples[ch] == UINT16_MAX) {
+        samples[ch] = r[1] | (r[2] >> 6) << 8;
+      }
+    }
+  }
+  // a channel that's never sampled reads as full scale (no key pressed),
+  // the bandgap as a healthy supply so the power monitor stays quiet
+  if (samples[BOARD_ADC_BANDGAP & (TRACE_CHANNELS - 1)] == UINT16_MAX) {
+    samples[BOARD_ADC_BANDGAP & (TRACE_CHANNELS - 1)] = BANDGAP;
+  }
+  for (int ch = 0; ch < TRACE_CHANNELS; ch++) {
+    if (samples[ch] == UINT16_MAX) {
+      samples[ch] = 0x3FF;
+    }
+  }
+  if (!end) {
+    end = time + TAIL;
+  }
+
+  // skip the settings
+  while (next < traceSize && (trace[next] & TRACE_KIND) == TRACE_EEPROM) {
+    next += TRACE_RECORD_SIZE;
+  }
+  if (next < traceSize) {
+    due = recordDt(&trace[next]);
+  }
+}
+
+// apply the records that are due
+static void playRecords() {
+  while (next < traceSize && due <= now) {
+    const uint8_t *r = &trace[next];
+
+    switch (r[0] & TRACE_KIND) {
+    case TRACE_ADC:
+      samples[r[0] & (TRACE_CHANNELS - 1)] = r[1] | (r[2] >> 6) << 8;
+      break;
+    case TRACE_KEY:
+      BOARD_KEYPAD_VECT();
+      break;
+    }
+
+    next += TRACE_RECORD_SIZE;
+    if (next < traceSize) {
+      due += recordDt(&trace[next]);
+    }
+  }
+}
+
+// print whatever changed since the last step
+static void report() {
+  if (currentState != reportedState) {
+    reportedState = currentState;
+    printf("%lu state %d\n", (unsigned long)now, currentState);
+  }
+
+  uint8_t duty[FAN_CHANNELS] = {BOARD_PWM_TABLE(PWM_DUTY)};
+  for (int ch = 0; ch < FAN_CHANNELS; ch++) {
+    if (duty[ch] != reportedDuty[ch]) {
+      reportedDuty[ch] = duty[ch];
+      printf("%lu pwm %d %d\n", (unsigned long)now, ch, duty[ch]);
+    }
+  }
+
+  char screen[sizeof(reportedScreen)];
+  for (int row = 0; row < HD44780_ROWS; row++) {
+    for (int col = 0; col < VISIBLE_COLS; col++) {
+      uint8_t c = hd44780Char(row, col);
+      if (c < 0x20 || c > 0x7D) {
+        c = '?';
+      }
+      screen[row * VISIBLE_COLS + col] = c;
+    }
+  }
+  screen[sizeof(screen) - 1] = '\0';
+  if (strcmp(screen, reportedScreen) != 0) {
+    strcpy(reportedScreen, screen);
+    printf("%lu lcd |%.*s|%s|\n", (unsigned long)now, VISIBLE_COLS, screen,
+           screen + VISIBLE_COLS);
+  }
+}
+
+void replayStep() {
+  now++;
+  TIMER0_COMPA_vect();
+  TIMER0_COMPB_vect();
+  if (now % 1000 == 0) {
+    TIMER1_COMPA_vect();
+  }
+  playRecords();
+  report();
+
+  if (now >= end) {
+    printf("%lu end\n", (unsigned long)now);
+    exit(0);
+  }
+}
+
+uint16_t traceReplayAdc(uint8_t channel) {
+  return samples[channel & (TRACE_CHANNELS - 1)];
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2 || argc > 3) {
+    usage();
+  }
+  if (argc == 3) {
+    end = strtoul(argv[2], NULL, 0);
+  }
+  loadTrace(argv[1]);
+  scanTrace();
+
+  memset(reportedScreen, ' ', sizeof(reportedScreen) - 1);
+  return app_main();
+}
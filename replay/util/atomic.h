@@ -0,0 +1,11 @@
+#ifndef REPLAY_UTIL_ATOMIC_H
+#define REPLAY_UTIL_ATOMIC_H
+
+// Host stand-in for <util/atomic.h>, the harness only "interrupts" between
+// main loop passes
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) for (int atomicOnce = 1; atomicOnce; atomicOnce = 0)
+
+#endif
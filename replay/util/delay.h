@@ -0,0 +1,12 @@
+#ifndef REPLAY_UTIL_DELAY_H
+#define REPLAY_UTIL_DELAY_H
+
+// Host stand-in for <util/delay.h>. Busy waits don't advance the harness's
+// clock, they're where the LCD pins are handed to the HD44780 model
+
+void replayDelay(double us);
+
+#define _delay_ms(ms) replayDelay((ms) * 1000.0)
+#define _delay_us(us) replayDelay(us)
+
+#endif
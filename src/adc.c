@@ -1,7 +1,19 @@
+#include "../include/trace.h"
 #include <avr/io.h>
 #include <inttypes.h>
 
+#ifndef TRACE_REPLAY
+static volatile uint8_t reading = 0; // adcRead() owns the ADC
+
+// select a channel
+static void selectChannel(uint8_t ch);
+
+// run a conversion of the selected channel
+static uint16_t convert();
+#endif
+
 void adcInit() {
+#ifndef TRACE_REPLAY
   // Set reference voltage to AVCC
   ADMUX = (1 << REFS0);
 
@@ -12,19 +24,77 @@ void adcInit() {
   ADCSRA |= (1 << ADSC);
   while (ADCSRA & (1 << ADSC))
     ;
+#endif
 }
 
 uint16_t adcRead(uint8_t ch) {
+#ifdef TRACE_REPLAY
+  return traceReplayAdc(ch);
+#else
+  reading = 1;
+  selectChannel(ch);
+  uint16_t value = convert();
+  reading = 0;
+
+#ifdef TRACE_RECORD
+  traceAdc(ch, value);
+#endif
+
+  // Return ADC result (10-bit value)
+  return value;
+#endif
+}
+
+uint16_t adcReadIsr(uint8_t ch) {
+#ifdef TRACE_REPLAY
+  return traceReplayAdc(ch);
+#else
+  uint8_t admux = ADMUX;
+#ifdef MUX5
+  uint8_t adcsrb = ADCSRB;
+#endif
+
+  // let a conversion adcRead() started finish, the first conversion after
+  // switching channels isn't settled
+  while (ADCSRA & (1 << ADSC))
+    ;
+  selectChannel(ch);
+  convert();
+  uint16_t value = convert();
+
+  // put adcRead()'s channel back, and its result if it may be waiting for it
+  ADMUX = admux;
+#ifdef MUX5
+  ADCSRB = adcsrb;
+#endif
+  if (reading) {
+    convert();
+  }
+  return value;
+#endif
+}
+
+#ifndef TRACE_REPLAY
+static void selectChannel(uint8_t ch) {
   // Select ADC channel
-  ADMUX = (ADMUX & 0xF0) | (ch & 0x0F);
+  ADMUX = (ADMUX & 0xE0) | (ch & 0x1F);
+#ifdef MUX5
+  // channels 8-15 are selected with MUX5 (bit 5 of ch)
+  if (ch & 0x20) {
+    ADCSRB |= (1 << MUX5);
+  } else {
+    ADCSRB &= ~(1 << MUX5);
+  }
+#endif
+}
 
+static uint16_t convert() {
   // Start conversion
   ADCSRA |= (1 << ADSC);
 
   // Wait for conversion to complete
   while (ADCSRA & (1 << ADSC))
     ;
-
-  // Return ADC result (10-bit value)
   return ADC;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
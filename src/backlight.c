@@ -0,0 +1,93 @@
+#include "../include/backlight.h"
+#include "../include/util.h"
+#include <inttypes.h>
+#include <util/atomic.h>
+
+_Static_assert(BACKLIGHT_CHANNEL < BOARD_PWM_COUNT,
+               "backlight on a missing PWM channel");
+
+static volatile Backlight state = LIGHT_ON;
+static volatile uint8_t idle = 0; // seconds since the last key
+static uint8_t idleTicks = 0;
+static uint8_t duty = BACKLIGHT_FULL;
+static Timer tickTimer;
+
+void backlightInit() {
+  state = LIGHT_ON;
+  idle = 0;
+  duty = BACKLIGHT_FULL;
+#ifdef BACKLIGHT_PWM
+  pwmSetDuty(BACKLIGHT_CHANNEL, duty);
+#endif
+  timerArm(&tickTimer, BACKLIGHT_TICK, BACKLIGHT_TICK, backlightTick);
+}
+
+void backlightTick() {
+  // backlightWake() may run in between
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (++idleTicks == BACKLIGHT_TICKS) {
+      idleTicks = 0;
+      if (idle != UINT8_MAX) {
+        idle++;
+      }
+    }
+
+    switch (state) {
+    case LIGHT_ON:
+      if (idle >= BACKLIGHT_FADE_TIME) {
+        state = LIGHT_FADE;
+      }
+      break;
+
+    case LIGHT_FADE:
+      if (duty > BACKLIGHT_DIM + BACKLIGHT_FADE_STEP) {
+        duty -= BACKLIGHT_FADE_STEP;
+      } else {
+        duty = BACKLIGHT_DIM;
+        state = LIGHT_DIM;
+      }
+#ifdef BACKLIGHT_PWM
+      pwmSetDuty(BACKLIGHT_CHANNEL, duty);
+#endif
+      break;
+
+    case LIGHT_DIM:
+      if (idle >= BACKLIGHT_OFF_TIME) {
+        duty = 0;
+#ifdef BACKLIGHT_PWM
+        pwmSetDuty(BACKLIGHT_CHANNEL, duty);
+#endif
+        state = LIGHT_OFF;
+      }
+      break;
+
+    case LIGHT_OFF:
+      break;
+    }
+  }
+}
+
+uint8_t backlightWake() {
+  uint8_t asleep = state == LIGHT_OFF;
+
+  idle = 0;
+  idleTicks = 0;
+  duty = BACKLIGHT_FULL;
+#ifdef BACKLIGHT_PWM
+  pwmSetDuty(BACKLIGHT_CHANNEL, duty);
+#endif
+  state = LIGHT_ON;
+  return asleep;
+}
+
+void backlightUpdate(LCD *lcd) {
+  uint8_t on = lcd->displaycontrol & LCD_DISPLAYON;
+
+  if (state == LIGHT_OFF && on) {
+    lcdDisplayOff(lcd);
+  } else if (state != LIGHT_OFF && !on) {
+    lcdDisplayOn(lcd);
+  }
+}
+
+uint8_t backlightAsleep() { return state == LIGHT_OFF; }
@@ -0,0 +1,65 @@
+#include "../include/boot.h"
+#include <avr/io.h>
+#include <avr/wdt.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <util/crc16.h>
+
+// state that survives a watchdog or brown-out reset
+typedef struct {
+  Vars vars;
+  Zones zones;
+  State state;
+  uint16_t crc;
+} Retained;
+
+// .noinit is neither cleared nor initialized by the startup code
+static Retained retained __attribute__((section(".noinit")));
+static uint8_t resetFlags __attribute__((section(".noinit")));
+
+// runs before main: save and clear MCUSR, otherwise the watchdog stays
+// enabled with its shortest timeout after a watchdog reset
+void bootEarly(void) __attribute__((naked, used, section(".init3")));
+void bootEarly(void) {
+  resetFlags = MCUSR;
+  MCUSR = 0;
+  wdt_disable();
+}
+
+static uint16_t retainedCrc() {
+  const uint8_t *p = (const uint8_t *)&retained;
+  const uint8_t *end = p + offsetof(Retained, crc);
+  uint16_t crc = 0xFFFF;
+  while (p < end) {
+    crc = _crc16_update(crc, *p++);
+  }
+  return crc;
+}
+
+ResetCause bootResetCause() {
+  if (resetFlags & (1 << PORF)) {
+    return POWERON_RESET;
+  } else if (resetFlags & (1 << WDRF)) {
+    return WATCHDOG_RESET;
+  } else if (resetFlags & (1 << BORF)) {
+    return BROWNOUT_RESET;
+  }
+  return EXTERNAL_RESET;
+}
+
+void bootSave(const Vars *vars, const Zones *zones, State state) {
+  retained.vars = *vars;
+  retained.zones = *zones;
+  retained.state = state;
+  retained.crc = retainedCrc();
+}
+
+uint8_t bootRestore(Vars *vars, Zones *zones, State *state) {
+  if (retained.crc != retainedCrc()) {
+    return 0;
+  }
+  *vars = retained.vars;
+  *zones = retained.zones;
+  *state = retained.state;
+  return 1;
+}
@@ -0,0 +1,21 @@
+#include "../include/event.h"
+#include <inttypes.h>
+
+Event eventQueue[EVENT_QUEUE_SIZE];
+volatile uint8_t eventHead = 0;
+volatile uint8_t eventTail = 0;
+volatile uint8_t eventDropped[EVENT_TYPES];
+volatile uint8_t eventDroppedTotal = 0;
+
+uint8_t eventPoll(Event *event) {
+  uint8_t tail = eventTail;
+
+  if (tail == eventHead) {
+    return 0;
+  }
+  *event = eventQueue[tail];
+  // free the slot only after it's read
+  __asm__ __volatile__("" ::: "memory");
+  eventTail = (tail + 1) & (EVENT_QUEUE_SIZE - 1);
+  return 1;
+}
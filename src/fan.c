@@ -0,0 +1,79 @@
+#include "../include/fan.h"
+#include "../include/main.h"
+#include "../include/util.h"
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <inttypes.h>
+
+extern Zones zones;
+
+_Static_assert(EEPROM_ZONE_THRESHOLD(ZONE_COUNT - 1) < EEPROM_FAN_CURVE,
+               "zone settings overlap the fan curve in EEPROM");
+
+static const CurvePoint defaultCurve[FAN_CURVE_POINTS] PROGMEM = {
+    {28, 30},
+    {35, 60},
+    {42, 100},
+};
+
+CurvePoint fanCurve[FAN_CURVE_POINTS];
+FanStep fanTable[ZONE_COUNT][MAX_TEMP - MIN_TEMP + 1];
+
+// 1 if the temperatures of the curve are increasing and the duties in range
+static uint8_t valid();
+
+void fanLoad() {
+  eeprom_read_block((void *)fanCurve, (const void *)EEPROM_FAN_CURVE,
+                    sizeof(fanCurve));
+  if (!valid()) {
+    // never saved (erased EEPROM)
+    memcpy_P(fanCurve, defaultCurve, sizeof(fanCurve));
+  }
+  fanCompile();
+}
+
+void fanSave() {
+  eeprom_update_block((const void *)fanCurve, (void *)EEPROM_FAN_CURVE,
+                      sizeof(fanCurve));
+  fanCompile();
+}
+
+void fanCompile() {
+  uint8_t i = 0;
+
+  for (uint8_t temp = MIN_TEMP; temp <= MAX_TEMP; temp++) {
+    const CurvePoint *lo = &fanCurve[i];
+    uint8_t duty;
+
+    // move on to the segment the temperature is in
+    while (i < FAN_CURVE_POINTS - 1 && temp >= fanCurve[i + 1].temp) {
+      lo = &fanCurve[++i];
+    }
+
+    if (temp <= lo->temp || i == FAN_CURVE_POINTS - 1) {
+      duty = lo->duty;
+    } else {
+      const CurvePoint *hi = lo + 1;
+      duty = lo->duty + ((int16_t)(hi->duty - lo->duty) * (temp - lo->temp)) /
+                            (hi->temp - lo->temp);
+    }
+
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      uint8_t capped = duty > zones.maxSpeed[z] ? zones.maxSpeed[z] : duty;
+      fanTable[z][temp - MIN_TEMP] = (FanStep){capped, PERCENT_TO_PWM(capped)};
+    }
+  }
+}
+
+static uint8_t valid() {
+  for (uint8_t i = 0; i < FAN_CURVE_POINTS; i++) {
+    if (fanCurve[i].temp > MAX_TEMP || fanCurve[i].duty < MIN_SPEED ||
+        fanCurve[i].duty > MAX_SPEED) {
+      return 0;
+    }
+    if (i && fanCurve[i].temp <= fanCurve[i - 1].temp) {
+      return 0;
+    }
+  }
+  return 1;
+}
@@ -1,38 +1,76 @@
 #include "../include/lcd.h"
+#include "../include/board.h"
+#include "../include/mirror.h"
 #include <avr/io.h>
+#include <avr/pgmspace.h>
 #include <stdio.h>
 #include <util/delay.h>
 
-LCD lcdInit(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5, uint8_t d6,
-            uint8_t d7, uint8_t cols, uint8_t rows, uint8_t charsize) {
-  LCD lcd = {
-      .rs_pin = rs,
-      .enable_pin = enable,
-      .data_pins = {0, 0, 0, 0, d4, d5, d6, d7},
-      .displayfunction = LCD_4BITMODE | LCD_2LINE | LCD_5x8DOTS,
-      .numlines = rows,
-  };
+#ifdef LCD_I2C_ADDR
+#include "../include/twi.h"
 
-  // set the starting DDRAM address offset for each row of the LCD
-  setRowOffsets(&lcd, 0x00, 0x40, 0x00, 0x40);
+// PCF8574 backpack: P0 RS, P1 RW, P2 EN, P3 backlight, P4-P7 D4-D7
+#define I2C_RS 0x01
+#define I2C_EN 0x04
+#define I2C_BACKLIGHT 0x08
+#define I2C_BATCH 64 // expander bytes per bus transaction
 
-  // set register select and enable pin as output
-  PORTB = 0x00;
-  DDRB |= (1 << rs) | (1 << enable);
-  // set data pins as output
-  PORTD = 0x00;
-  DDRD |= (1 << d4) | (1 << d5) | (1 << d6) | (1 << d7);
+static uint8_t i2cBuffer[I2C_BATCH];
+static uint8_t i2cLength = 0;
+static volatile uint8_t i2cPending = 0; // i2cBuffer is being sent
+static uint8_t i2cRs = 0;               // RS for the next nibble
+static uint8_t i2cBusRs = 0;            // RS currently on the expander
+static uint8_t batching = 0;            // lcdPrint is collecting bytes
+
+static void i2cDone(uint8_t status) { i2cPending = 0; }
+#endif
+
+#ifndef LCD_I2C_ADDR
+// the pins within the ports are passed to lcdInit()
+#define CTRL_PORT BOARD_LCD_CTRL_PORT // RS and EN
+#define CTRL_DDR BOARD_LCD_CTRL_DDR
+#define DATA_PORT BOARD_LCD_DATA_PORT // D4-D7
+#define DATA_DDR BOARD_LCD_DATA_DDR
+#define DATA_MASK                                                              \
+  ((1 << BOARD_LCD_D4) | (1 << BOARD_LCD_D5) | (1 << BOARD_LCD_D6) |          \
+   (1 << BOARD_LCD_D7))
+#endif
+
+static uint8_t marqueeShift = 0; // columns the display is scrolled by
+
+// send 4 bits (used by sendData())
+static void write4bits(LCD lcd, uint8_t value);
+
+// send what write4bits() queued for the I2C backpack, wait for the bus if
+// wait is set (no-op with GPIO)
+static void flush(uint8_t wait);
+
+// pulse EN pin to let LCD know of new incoming data/command
+static void pulse(LCD lcd);
+
+// set the starting DDRAM address offset for each row of the LCD
+static void setRowOffsets(LCD *lcd, uint8_t row0, uint8_t row1, uint8_t row2,
+                          uint8_t row3);
+
+LCD lcdInit(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5, uint8_t d6,
+            uint8_t d7, uint8_t cols, uint8_t rows, uint8_t charsize) {
+  LCD lcd = lcdAttach(rs, enable, d4, d5, d6, d7, cols, rows, charsize);
 
   // wait 50ms before sending commands
   _delay_ms(50);
 
   // set LCD to 4-bit mode
-  PORTB &= ~((1 << rs) | (1 << enable));
+#ifndef LCD_I2C_ADDR
+  CTRL_PORT &= ~((1 << rs) | (1 << enable));
+#endif
   write4bits(lcd, 0x03);
+  flush(1);
   _delay_ms(5);
   write4bits(lcd, 0x03);
+  flush(1);
   _delay_ms(5);
   write4bits(lcd, 0x03);
+  flush(1);
   _delay_us(150);
   write4bits(lcd, 0x02);
 
@@ -40,25 +78,55 @@ LCD lcdInit(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5, uint8_t d6,
   sendCommand(lcd, LCD_FUNCTIONSET | lcd.displayfunction);
 
   // true on display with no cursor and blinking then clear it
-  lcd.displaycontrol = LCD_DISPLAYON | LCD_CURSOROFF | LCD_BLINKOFF;
   lcdDisplayOn(&lcd);
   lcdClear(lcd);
 
   // set entry mode
-  lcd.displaymode = LCD_ENTRYLEFT | LCD_ENTRYSHIFTDECREMENT;
   sendCommand(lcd, LCD_ENTRYMODESET | lcd.displaymode);
 
   _delay_ms(50);
   return lcd;
 }
 
+LCD lcdAttach(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5, uint8_t d6,
+              uint8_t d7, uint8_t cols, uint8_t rows, uint8_t charsize) {
+  LCD lcd = {
+      .rs_pin = rs,
+      .enable_pin = enable,
+      .data_pins = {0, 0, 0, 0, d4, d5, d6, d7},
+      .displayfunction = LCD_4BITMODE | LCD_2LINE | LCD_5x8DOTS,
+      .displaycontrol = LCD_DISPLAYON | LCD_CURSOROFF | LCD_BLINKOFF,
+      .displaymode = LCD_ENTRYLEFT | LCD_ENTRYSHIFTDECREMENT,
+      .numlines = rows,
+  };
+
+  // set the starting DDRAM address offset for each row of the LCD
+  setRowOffsets(&lcd, 0x00, 0x40, 0x00, 0x40);
+
+#ifdef LCD_I2C_ADDR
+  // the pins are on the I2C backpack, rs/enable/d4-d7 are ignored
+  twiInit();
+#else
+  // set register select and enable pin as output
+  CTRL_PORT = 0x00;
+  CTRL_DDR |= (1 << rs) | (1 << enable);
+  // set data pins as output
+  DATA_PORT = 0x00;
+  DATA_DDR |= (1 << d4) | (1 << d5) | (1 << d6) | (1 << d7);
+#endif
+
+  return lcd;
+}
+
 void lcdHome(LCD lcd) {
   sendCommand(lcd, LCD_RETURNHOME);
+  flush(1);
   _delay_ms(2);
 }
 
 void lcdClear(LCD lcd) {
   sendCommand(lcd, LCD_CLEARDISPLAY);
+  flush(1);
   _delay_ms(2);
 }
 
@@ -74,17 +142,81 @@ void lcdSetCursor(LCD lcd, uint8_t row, uint8_t col) {
 }
 
 void lcdPrint(LCD lcd, const char *str) {
+#ifdef LCD_I2C_ADDR
+  // send the whole string in as few bus transactions as possible
+  batching = 1;
+#endif
   while (*str) {
     sendData(lcd, *str++);
   }
+#ifdef LCD_I2C_ADDR
+  batching = 0;
+#endif
+  flush(0);
+}
+
+void lcdPrint_P(LCD lcd, const char *str) {
+  char c;
+#ifdef LCD_I2C_ADDR
+  batching = 1;
+#endif
+  while ((c = pgm_read_byte(str++))) {
+    sendData(lcd, c);
+  }
+#ifdef LCD_I2C_ADDR
+  batching = 0;
+#endif
+  flush(0);
 }
 
 void lcdPrintNum(LCD lcd, uint32_t num) {
   char buffer[16];
-  snprintf(buffer, sizeof(buffer), "%lu", num);
+  snprintf_P(buffer, sizeof(buffer), PSTR("%lu"), num);
   lcdPrint(lcd, buffer);
 }
 
+uint8_t lcdMarquee(LCD lcd, uint8_t row, const char *str) {
+  uint8_t length = 0;
+  char c;
+
+  lcdMarqueeStop(lcd);
+  lcdSetCursor(lcd, row, 0);
+#ifdef LCD_I2C_ADDR
+  batching = 1;
+#endif
+  // the string once, then blanks so the end of it scrolls off cleanly
+  while (length < LCD_DDRAM_COLS && (c = pgm_read_byte(str++))) {
+    sendData(lcd, c);
+    length++;
+  }
+  for (uint8_t i = length; i < LCD_DDRAM_COLS; i++) {
+    sendData(lcd, ' ');
+  }
+#ifdef LCD_I2C_ADDR
+  batching = 0;
+#endif
+  flush(0);
+  return length;
+}
+
+uint8_t lcdMarqueeStep(LCD lcd) {
+  sendCommand(lcd, LCD_CURSORSHIFT | LCD_DISPLAYMOVE | LCD_MOVELEFT);
+  marqueeShift++;
+  if (marqueeShift == LCD_DDRAM_COLS) {
+    // DDRAM is circular, we're back at the start
+    marqueeShift = 0;
+  }
+  return marqueeShift;
+}
+
+void lcdMarqueeStop(LCD lcd) {
+  if (marqueeShift) {
+    // return home also undoes the display shift
+    lcdHome(lcd);
+    marqueeShift = 0;
+  }
+}
+
 void lcdDisplayOn(LCD *lcd) {
   lcd->displaycontrol |= LCD_DISPLAYON;
   sendCommand(*lcd, LCD_DISPLAYCONTROL | lcd->displaycontrol);
@@ -96,35 +228,103 @@ void lcdDisplayOff(LCD *lcd) {
 }
 
 void sendCommand(LCD lcd, uint8_t cmd) {
-  PORTB &= ~(1 << lcd.rs_pin);
+#ifdef LCD_I2C_ADDR
+  i2cRs = 0;
+#else
+  CTRL_PORT &= ~(1 << lcd.rs_pin);
+#endif
   write4bits(lcd, cmd >> 4);
   write4bits(lcd, cmd);
+  flush(0);
+#ifdef LCD_MIRROR
+  mirrorCommand(cmd);
+#endif
 }
 
 void sendData(LCD lcd, uint8_t data) {
-  PORTB |= (1 << lcd.rs_pin);
+#ifdef LCD_I2C_ADDR
+  i2cRs = I2C_RS;
+#else
+  CTRL_PORT |= (1 << lcd.rs_pin);
+#endif
   write4bits(lcd, data >> 4);
   write4bits(lcd, data);
+#ifdef LCD_MIRROR
+  mirrorData(data);
+#endif
+#ifdef LCD_I2C_ADDR
+  if (!batching) {
+    flush(0);
+  }
+#endif
+}
+
+#ifdef LCD_I2C_ADDR
+static void write4bits(LCD lcd, uint8_t value) {
+  uint8_t bits = (value << 4) | i2cRs | I2C_BACKLIGHT;
+
+  // make room for up to 3 bytes
+  if (i2cLength + 3 > I2C_BATCH) {
+    flush(0);
+  }
+  // the buffer is still being sent
+  while (i2cPending)
+    ;
+
+  // RS must be stable before EN goes high
+  if (i2cRs != i2cBusRs) {
+    i2cBuffer[i2cLength++] = bits;
+    i2cBusRs = i2cRs;
+  }
+  // EN high then low, the LCD latches on the falling edge
+  i2cBuffer[i2cLength++] = bits | I2C_EN;
+  i2cBuffer[i2cLength++] = bits;
 }
 
+static void flush(uint8_t wait) {
+  if (i2cLength) {
+    TwiTransaction t = {
+        .address = LCD_I2C_ADDR,
+        .txData = i2cBuffer,
+        .txLength = i2cLength,
+        .done = i2cDone,
+    };
+    while (i2cPending)
+      ;
+    i2cPending = 1;
+    while (!twiSubmit(&t))
+      ;
+    i2cLength = 0;
+  }
+  if (wait) {
+    while (i2cPending)
+      ;
+  }
+}
+#else
 static void write4bits(LCD lcd, uint8_t value) {
-  PORTD = (PORTD & (~0xF0)) | ((((value >> 0) & 0x01) << lcd.data_pins[4]) |
-                               (((value >> 1) & 0x01) << lcd.data_pins[5]) |
-                               (((value >> 2) & 0x01) << lcd.data_pins[6]) |
-                               (((value >> 3) & 0x01) << lcd.data_pins[7]));
+  DATA_PORT = (DATA_PORT & (~DATA_MASK)) |
+              ((((value >> 0) & 0x01) << lcd.data_pins[4]) |
+               (((value >> 1) & 0x01) << lcd.data_pins[5]) |
+               (((value >> 2) & 0x01) << lcd.data_pins[6]) |
+               (((value >> 3) & 0x01) << lcd.data_pins[7]));
   pulse(lcd);
 }
 
+// GPIO writes go out immediately, nothing to do
+static void flush(uint8_t wait) {}
+
 static void pulse(LCD lcd) {
   // to set a bit LOW: AND the register with INV of the desired MASK
   // to set a bit HIGH: OR the register with the desired MASK
-  PORTB &= ~(1 << lcd.enable_pin);
+  CTRL_PORT &= ~(1 << lcd.enable_pin);
   _delay_us(1);
-  PORTB |= (1 << lcd.enable_pin);
+  CTRL_PORT |= (1 << lcd.enable_pin);
   _delay_us(1);
-  PORTB &= ~(1 << lcd.enable_pin);
+  CTRL_PORT &= ~(1 << lcd.enable_pin);
   _delay_us(100);
 }
+#endif
 
 static void setRowOffsets(LCD *lcd, uint8_t row0, uint8_t row1, uint8_t row2,
                           uint8_t row3) {
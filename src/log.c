@@ -0,0 +1,69 @@
+#include "../include/log.h"
+#include "../include/proto.h"
+#include "../include/uart.h"
+#include <inttypes.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
+
+_Static_assert(LOG_MAX_ARGS * 2 + 2 <= PROTO_MAX_PAYLOAD,
+               "log message too long for a frame");
+_Static_assert(LOG_SIZE <= 256 && (LOG_SIZE & (LOG_SIZE - 1)) == 0,
+               "LOG_SIZE must be a power of 2 up to 256");
+
+static uint8_t ring[LOG_SIZE];
+static volatile uint8_t head = 0; // moved by logWrite()
+static volatile uint8_t tail = 0; // moved by the UART TX ISR
+static uint8_t remaining = 0;     // bytes left of the frame being sent
+volatile uint8_t logDropped = 0;
+
+void logWrite(uint16_t id, const uint16_t *args, uint8_t count) {
+  uint8_t frame[LOG_MAX_ARGS * 2 + 7];
+  uint8_t len = count * 2 + 2;
+  uint16_t crc = 0xFFFF;
+
+  // build the frame first, only the copy needs interrupts off
+  frame[0] = PROTO_SOF;
+  frame[1] = len;
+  frame[2] = PROTO_LOG;
+  frame[3] = id & 0xFF;
+  frame[4] = id >> 8;
+  for (uint8_t i = 0; i < count; i++) {
+    frame[5 + 2 * i] = args[i] & 0xFF;
+    frame[6 + 2 * i] = args[i] >> 8;
+  }
+  for (uint8_t i = 1; i < len + 3; i++) {
+    crc = _crc_ccitt_update(crc, frame[i]);
+  }
+  frame[len + 3] = crc & 0xFF;
+  frame[len + 4] = crc >> 8;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (((tail - head - 1) & (LOG_SIZE - 1)) < len + 5) {
+      if (logDropped != UINT8_MAX) {
+        logDropped++;
+      }
+    } else {
+      for (uint8_t i = 0; i < len + 5; i++) {
+        ring[head] = frame[i];
+        head = (head + 1) & (LOG_SIZE - 1);
+      }
+      uartKick();
+    }
+  }
+}
+
+int16_t logNext(uint8_t start) {
+  uint8_t byte;
+
+  if (!remaining) {
+    if (!start || tail == head) {
+      return -1;
+    }
+    // SOF, len, cmd, payload, crc
+    remaining = ring[(tail + 1) & (LOG_SIZE - 1)] + 5;
+  }
+  byte = ring[tail];
+  tail = (tail + 1) & (LOG_SIZE - 1);
+  remaining--;
+  return byte;
+}
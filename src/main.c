@@ -1,60 +1,95 @@
 #include "include/main.h"
 #include "include/adc.h"
+#include "include/backlight.h"
+#include "include/board.h"
+#include "include/boot.h"
+#include "include/event.h"
+#include "include/fan.h"
 #include "include/lcd.h"
+#include "include/log.h"
+#include "include/menu.h"
+#include "include/mirror.h"
+#include "include/pattern.h"
+#include "include/power.h"
+#include "include/proto.h"
+#include "include/rtc.h"
+#include "include/scratch.h"
+#include "include/stats.h"
+#include "include/trace.h"
+#include "include/trend.h"
+#include "include/twi.h"
+#include "include/uart.h"
 #include "include/util.h"
+#include "include/wheel.h"
 #include <avr/eeprom.h>
 #include <avr/interrupt.h>
 #include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/wdt.h>
 #include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
-#include <util/delay.h>
+#include <util/atomic.h>
+
+// Timer1 compare value for 1s with the prescaler at 1024
+#define SECOND_RELOAD (F_CPU / 1024 - 1)
+_Static_assert(SECOND_RELOAD <= 0xFFFF, "F_CPU too fast for the 1s timer");
+_Static_assert(PASSWORD_LENGTH == 4, "the short password message says 4");
+
+// every zone needs a fan channel of the board
+#define ZONE_FAN_CHECK(sensor, fan)                                            \
+  _Static_assert(fan < BOARD_PWM_COUNT, "zone fan on a missing PWM channel");
+ZONE_TABLE(ZONE_FAN_CHECK)
 
 LCD lcd;
 State currentState;
 State lastState;
-char buffer[BUFFER_SIZE];             // text buffer
-char passBuffer[PASSWORD_LENGTH + 1]; // password buffer
-Input keyInput = 0;
-Vars vars = {
-    .currentTemp = 0,
-    .lastTemp = 0,
-    .tempDiff = 0,
-    .motorOn = 0,
-    .speed = 0,
+const MenuNode settingsMenu[] PROGMEM = {
+    MENU_EDITOR("1.Change Pass", CHANGE_PASS),
+    MENU_EDITOR("2.Temp Thresh", CHANGE_TEMP),
+    MENU_EDITOR("3.Motor Speed", CHANGE_SPEED),
+    MENU_EDITOR("4.Fan Curve", CHANGE_CURVE),
 };
-volatile uint8_t seconds = 0;
-volatile uint8_t timeoutFlag = 0;
-
-ISR(TIMER1_COMPA_vect) {
-  seconds++;
-  // emulate an RTC
-  vars.time[2]++;
-  if (vars.time[2] == 60) {
-    vars.time[2] = 0;
-    vars.time[1]++;
-  }
-  if (vars.time[1] == 60) {
-    vars.time[1] = 0;
-    vars.time[0]++;
-  }
-
-  // Emulating a TIMEOUT second watchdog
-  if (seconds >= TIMEOUT) {
-    currentState = STATUS;
-    lastState = NOSTATE;
-    timeoutFlag = 1;
-    seconds = 0;
-  }
-}
-
-// ISR for PC0 (Keypad)
-ISR(PCINT1_vect) {
-  if (!(PINC & PINC0)) { // PC0 is low
-    if (currentState == STATUS) {
-      currentState = PASS;
-      lastState = STATUS;
-    }
+const MenuNode clockMenu[] PROGMEM = {
+    MENU_EDITOR("1.Set Time", CHANGE_TIME),
+    MENU_EDITOR("2.Set Alarm", SET_ALARM),
+};
+const MenuNode mainMenu[] PROGMEM = {
+    MENU_SUBMENU("1.Settings", settingsMenu),
+    MENU_SUBMENU("2.Clock", clockMenu),
+    MENU_EDITOR("3.Statistics", STATS),
+    MENU_ACTION("4.Lock", lock),
+};
+// screen of every state
+void (*const screens[])() PROGMEM = {
+    [STATUS] = displayStatus,       [PASS] = passwordHandler,
+    [MENU] = displayMenu,           [CHANGE_PASS] = changePassword,
+    [CHANGE_TEMP] = changeTemp,     [CHANGE_SPEED] = changeSpeed,
+    [CHANGE_TIME] = changeTime,     [SET_ALARM] = setAlarm,
+    [STATS] = displayStats,         [CHANGE_CURVE] = changeCurve,
+};
+Input keyInput = 0;
+Vars vars;
+Zones zones;
+const uint8_t zoneSensor[ZONE_COUNT] = {ZONE_TABLE(ZONE_SENSOR)};
+const uint8_t zoneFan[ZONE_COUNT] = {ZONE_TABLE(ZONE_FAN)};
+uint8_t rtcSynced = 0;     // software clock was synced this minute
+uint8_t timeoutFlag = 0;   // the screen timed out, return to status
+uint8_t waitDone = 0;      // waitMs() is over
+uint8_t alarmRounds = 0;   // times the alarm is still going to ring
+uint16_t alarmSnooze = 0;  // seconds until it rings again
+Timer controlTimer;        // motor control period
+Timer refreshTimer;        // status screen refresh
+Timer timeoutTimer;        // screen timeout
+Timer waitTimer;           // waitMs()
+
+ISR(TIMER1_COMPA_vect) { eventPost(EVENT_TICK, 0); }
+
+// ISR for the keypad pin
+ISR(BOARD_KEYPAD_VECT) {
+  if (!(BOARD_KEYPAD_PIN & BOARD_KEYPAD_BIT)) { // keypad pin is low
+    // the backlight comes back at once, the rest is up to the main loop
+    eventPost(EVENT_KEY_WAKE, backlightWake());
   }
 }
 
@@ -62,58 +97,57 @@ int main() {
   systemInit();
 
   while (1) {
-    // read temperature from sensor and adjust the motor
-    motorControl();
+    // timers, ISR events, serial requests, etc.
+    service();
 
-    // check if the alarm has went off
-    checkAlarm();
+    // retain state for a warm restart
+    bootSave(&vars, &zones, currentState);
 
     // State machine
     if (currentState != lastState) {
-      switch (currentState) {
-      case STATUS:
-        displayStatus();
-        break;
-
-      case PASS:
-        passwordHandler();
-        break;
-
-      case MENU:
-        displayMenu();
-        break;
-
-      case CHANGE_PASS:
-        changePassword();
-        break;
-
-      case CHANGE_TEMP:
-        changeTemp();
-        break;
-
-      case CHANGE_SPEED:
-        changeSpeed();
-        break;
-
-      case CHANGE_TIME:
-        changeTime();
-        break;
-
-      case SET_ALARM:
-        setAlarm();
-        break;
+      void (*screen)() = (void (*)())pgm_read_word(&screens[currentState]);
+      if (screen) {
+        // every screen starts from a zeroed scratch
+        scratchReset();
+        screen();
       }
     }
+
+    // a screen that timed out returns to status
+    if (timeoutFlag) {
+      timeoutFlag = 0;
+      currentState = STATUS;
+      lastState = NOSTATE;
+    }
   }
 
   return 0;
 }
 
 void systemInit() {
+#ifdef TRACE_RECORD
+  // the settings as they were before the boot changes them
+  traceInit();
+#endif
+  ResetCause cause = bootResetCause();
+  // after a watchdog or brown-out reset, continue where we left off
+  uint8_t warm = (cause == WATCHDOG_RESET || cause == BROWNOUT_RESET) &&
+                 bootRestore(&vars, &zones, &currentState);
+  State restored = NOSTATE; // state at the last power failure
+
+  // init the pwm channels (include/boards/), first so the fans keep spinning
+  pmwInit();
+  if (warm) {
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      pwmSetDuty(zoneFan[z], PERCENT_TO_PWM(zones.speed[z]));
+    }
+  }
+  backlightInit();
+
   /*
     // write default values to eeprom for the very first time
-    eeprom_write_byte((uint8_t *)0x00, vars.maxSpeed);
-    eeprom_write_byte((uint8_t *)0x01, vars.tempThreshold);
+    eeprom_write_byte((uint8_t *)0x00, zones.maxSpeed[0]);
+    eeprom_write_byte((uint8_t *)0x01, zones.tempThreshold[0]);
     eeprom_write_block((const void *)vars.time, (void *)0x02,
     sizeof(vars.time)); eeprom_write_block((const void *)vars.alarm, (void
     *)0x05,
@@ -122,150 +156,315 @@ void systemInit() {
                        sizeof(vars.password));
   */
 
-  vars.maxSpeed = eeprom_read_byte((uint8_t *)0x00);
-  vars.tempThreshold = eeprom_read_byte((uint8_t *)0x01);
-  eeprom_read_block((void *)vars.time, (const void *)0x02, sizeof(vars.time));
-  eeprom_read_block((void *)vars.alarm, (const void *)0x05, sizeof(vars.alarm));
-  eeprom_read_block((void *)vars.password, (const void *)0x08,
-                    sizeof(vars.password));
+  if (!warm) {
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      zones.maxSpeed[z] = eeprom_read_byte((uint8_t *)EEPROM_ZONE_MAX_SPEED(z));
+      zones.tempThreshold[z] =
+          eeprom_read_byte((uint8_t *)EEPROM_ZONE_THRESHOLD(z));
+    }
+    eeprom_read_block((void *)vars.time, (const void *)EEPROM_TIME,
+                      sizeof(vars.time));
+    eeprom_read_block((void *)vars.alarm, (const void *)EEPROM_ALARM,
+                      sizeof(vars.alarm));
+    eeprom_read_block((void *)vars.password, (const void *)EEPROM_PASSWORD,
+                      sizeof(vars.password));
+
+    // the clock and fan speeds at the last power failure are newer
+    if (powerRestore(&vars, &zones, &restored)) {
+      for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+        pwmSetDuty(zoneFan[z], PERCENT_TO_PWM(zones.speed[z]));
+      }
+    }
+  }
+  fanLoad();
 
-  // configure PC0 "pin change" interrupt
-  PCICR |= (1 << PCIE1);
-  PCMSK1 |= (1 << PCINT8);
+  // configure the keypad "pin change" interrupt
+  PCICR |= (1 << BOARD_KEYPAD_PCIE);
+  BOARD_KEYPAD_PCMSK |= (1 << BOARD_KEYPAD_PCINT);
 
   // configure timer 1 to generate an interrupt every 1s
   timerInit();
   startTimer();
 
-  // enable global interrupt
-  sei();
+  // configure timer 0 to tick every 1ms for the software timers
+  wheelInit();
 
-  // for debugging purposes
-  DDRD |= (1 << DDD0);
+  // serial command protocol
+  uartInit();
+  LOG_INFO("reset cause %u, warm start %u", cause, warm);
+#ifdef LCD_MIRROR
+  // stream the display contents
+  mirrorInit();
+#endif
 
-  // init display
-  lcd = lcdInit(DDB0, DDB1, DDD4, DDD5, DDD6, DDD7, 16, 2, LCD_5x8DOTS);
-  lcdClear(lcd);
+  // enable global interrupt
+  sei();
+#ifdef TRACE_RECORD
+  traceStart();
+#endif
+
+#ifdef RTC_DS1307
+  // the RTC kept counting while we were off (needs interrupts)
+  twiInit();
+  if (!warm) {
+    rtcRead(vars.time);
+    twiFlush();
+  }
+#endif
+
+  // buzzer and LED
+  patternInit();
+
+  // init display, the controller survives a watchdog reset so it's only
+  // re-initialized after power-on, external and brown-out resets
+  if (warm && cause == WATCHDOG_RESET) {
+    lcd = lcdAttach(BOARD_LCD_RS, BOARD_LCD_EN, BOARD_LCD_D4, BOARD_LCD_D5,
+                    BOARD_LCD_D6, BOARD_LCD_D7, 16, 2, LCD_5x8DOTS);
+    // it may have been switched off while idle
+    lcdDisplayOn(&lcd);
+  } else {
+    lcd = lcdInit(BOARD_LCD_RS, BOARD_LCD_EN, BOARD_LCD_D4, BOARD_LCD_D5,
+                  BOARD_LCD_D6, BOARD_LCD_D7, 16, 2, LCD_5x8DOTS);
+    lcdClear(lcd);
+  }
 
   // init adc
   adcInit();
 
-  // init timer 2 pwm (ch0: PB3, ch1: PD3)
-  pmwInit();
+  // checkpoint when the supply fails
+  powerInit();
 
-  // set default state
-  currentState = STATUS;
+  // set default state, screens behind the password aren't resumed after a
+  // power failure
+  if (!warm) {
+    currentState = restored == PASS ? PASS : STATUS;
+  }
   lastState = NOSTATE;
 
-  // clear buffers
-  buffer[0] = '\0';
-  passBuffer[0] = '\0';
+  // periodic work
+  motorControl();
+  timerArm(&controlTimer, CONTROL_PERIOD, CONTROL_PERIOD, motorControl);
+  timerArm(&refreshTimer, STATUS_REFRESH, STATUS_REFRESH, drawStatus);
+
+  // hardware watchdog, kicked from service()
+  wdt_enable(WDTO_2S);
+}
+
+void service() {
+  wdt_reset();
+
+  // run the software timers that are due
+  wheelRun();
+
+  // handle the events posted by the ISRs
+  handleEvents();
+
+  // handle serial requests
+  protoPoll();
+
+  // switch the display off when idle, back on after a key
+  backlightUpdate(&lcd);
+
+#ifdef RTC_DS1307
+  // pull the software clock back in step with the RTC once a minute
+  if (vars.time[2] == 0 && !rtcSynced) {
+    rtcRead(vars.time);
+    rtcSynced = 1;
+  } else if (vars.time[2] != 0) {
+    rtcSynced = 0;
+  }
+#endif
+}
+
+void waitMs(uint16_t ms) {
+  waitDone = 0;
+  timerArm(&waitTimer, ms, 0, waitOver);
+  while (!waitDone) {
+    service();
+  }
+}
+
+void waitOver() { waitDone = 1; }
+
+void armTimeout() {
+  timeoutFlag = 0;
+  timerArm(&timeoutTimer, TIMEOUT * 1000U, 0, timedOut);
 }
 
+void timedOut() { timeoutFlag = 1; }
+
 void motorControl() {
-  // read new temperature from sensor
-  vars.lastTemp = vars.currentTemp;
-  vars.currentTemp = (uint8_t)((adcRead(1) * MAX_TEMP) >> 10);
-  vars.tempDiff = vars.currentTemp - vars.lastTemp;
-
-  // check if motor should be turned on
-  if ((vars.currentTemp > vars.tempThreshold) && (vars.motorOn == 0)) {
-    vars.motorOn = 1;
-    vars.speed = MIN_SPEED;
-  } else if (vars.currentTemp < vars.tempThreshold) {
-    vars.motorOn = 0;
-    vars.speed = 0;
-  }
-
-  // adjust motor speed
-  if ((vars.motorOn) && (vars.tempDiff > 0)) {
-    // if temp is increasing speed up the motor
-    vars.speed += SPEED_STEP_SIZE;
-    if (vars.speed > vars.maxSpeed) {
-      vars.speed = vars.maxSpeed;
+  uint8_t z;
+  uint8_t lead[ZONE_COUNT]; // temperature the fans act on
+
+  // read new temperatures from the sensors
+  for (z = 0; z < ZONE_COUNT; z++) {
+    zones.currentTemp[z] =
+        (uint8_t)((adcRead(zoneSensor[z]) * MAX_TEMP) >> 10);
+  }
+
+  // while a zone heats up its fan acts on the temperature the trend
+  // projects TREND_LEAD samples ahead, so it spins up before the heat
+  // arrives; otherwise on the current one
+  trendSample(zones.currentTemp);
+  for (z = 0; z < ZONE_COUNT; z++) {
+    uint8_t rise = trendRise(z, TREND_LEAD);
+    lead[z] = zones.currentTemp[z] + rise > MAX_TEMP
+                  ? MAX_TEMP
+                  : zones.currentTemp[z] + rise;
+  }
+
+  // motors turn on above the threshold and off FAN_HYSTERESIS below it
+  for (z = 0; z < ZONE_COUNT; z++) {
+    if (lead[z] > zones.tempThreshold[z]) {
+      if (!zones.motorOn[z]) {
+        LOG_INFO("zone %u fan on at %u C", z + 1, zones.currentTemp[z]);
+      }
+      zones.motorOn[z] = 1;
+    } else if (lead[z] + FAN_HYSTERESIS <= zones.tempThreshold[z]) {
+      if (zones.motorOn[z]) {
+        LOG_INFO("zone %u fan off at %u C", z + 1, zones.currentTemp[z]);
+      }
+      zones.motorOn[z] = 0;
     }
-  } else if ((vars.motorOn) && (vars.tempDiff < 0)) {
-    // if temp is decreasing speed down the motor
-    vars.speed -= SPEED_STEP_SIZE;
-    if (vars.speed < MIN_SPEED || vars.speed > MAX_SPEED) {
-      vars.speed = 0;
+  }
+
+  // the curve follows a rising temperature at once, a falling one only
+  // FAN_HYSTERESIS degrees at a time, so the speed doesn't flap at a knee
+  for (z = 0; z < ZONE_COUNT; z++) {
+    if (lead[z] > zones.curveTemp[z] ||
+        lead[z] + FAN_HYSTERESIS <= zones.curveTemp[z]) {
+      zones.curveTemp[z] = lead[z];
     }
   }
-  pwmSetDuty(1, vars.speed * 255 / 100);
+
+  // read the outputs off the compiled fan curve
+  FanStep step[ZONE_COUNT];
+  for (z = 0; z < ZONE_COUNT; z++) {
+    step[z] = zones.motorOn[z] ? fanTable[z][zones.curveTemp[z] - MIN_TEMP]
+                               : (FanStep){0, 0};
+    zones.speed[z] = step[z].duty;
+  }
+
+  // update the outputs, the fans stay off while the supply is failing (the
+  // power ISR switches them off between the check and the writes otherwise)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    uint8_t off = powerLow();
+    for (z = 0; z < ZONE_COUNT; z++) {
+      pwmSetDuty(zoneFan[z], off ? 0 : step[z].pwm);
+    }
+  }
+
+  // warn while any zone is too hot
+  uint8_t hot = 0;
+  for (z = 0; z < ZONE_COUNT; z++) {
+    hot |= zones.currentTemp[z] >= OVER_TEMP;
+  }
+  if (hot) {
+    if (!patternActive(PATTERN_OVERTEMP)) {
+      LOG_WARN("over temperature");
+    }
+    patternPlay(PATTERN_OVERTEMP);
+  } else {
+    patternStop(PATTERN_OVERTEMP);
+  }
 }
 
 void displayStatus() {
-  seconds = 0;
+  // the status screen doesn't time out, it's refreshed by refreshTimer
+  timerCancel(&timeoutTimer);
   timeoutFlag = 0;
+  lastState = STATUS;
+  drawStatus();
+}
+
+void drawStatus() {
+  StatusScratch *status = &scratch.status;
+
+  // nobody is looking, leave the LCD alone. until displayStatus() has run the
+  // scratch still belongs to the screen we came from
+  if (currentState != STATUS || lastState != STATUS || backlightAsleep()) {
+    return;
+  }
   lcdClear(lcd);
   lcdSetCursor(lcd, 0, 0);
-  snprintf(buffer, BUFFER_SIZE, "Temp:%dC Motor:%d", vars.currentTemp,
-           vars.motorOn);
-  lcdPrint(lcd, buffer);
+#if ZONE_COUNT > 1
+  snprintf_P(scratch.line, BUFFER_SIZE, PSTR("Z%d:%dC Motor:%d"),
+             status->zone + 1, zones.currentTemp[status->zone],
+             zones.motorOn[status->zone]);
+#else
+  snprintf_P(scratch.line, BUFFER_SIZE, PSTR("Temp:%dC Motor:%d"),
+             zones.currentTemp[0], zones.motorOn[0]);
+#endif
+  lcdPrint(lcd, scratch.line);
   lcdSetCursor(lcd, 1, 0);
-  snprintf(buffer, BUFFER_SIZE, "Speed:%d%%of%d%%", vars.speed, vars.maxSpeed);
-  lcdPrint(lcd, buffer);
-  // to prevent screen refreshing very fast
-  _delay_ms(500);
+  snprintf_P(scratch.line, BUFFER_SIZE, PSTR("Speed:%d%%of%d%%"),
+             zones.speed[status->zone], zones.maxSpeed[status->zone]);
+  lcdPrint(lcd, scratch.line);
+
+  // page through the zones
+  status->refresh++;
+  if (status->refresh == STATUS_PAGE) {
+    status->refresh = 0;
+    status->zone = (status->zone + 1) % ZONE_COUNT;
+  }
 }
 
 void passwordHandler() {
-  // clear password buffer
-  passBuffer[0] = '\0';
+  char *entered = scratch.pass.entered;
   Input input;
 
   lcdClear(lcd);
   lcdSetCursor(lcd, 0, 0);
-  lcdPrint(lcd, "Enter Password:");
+  lcdPrint_P(lcd, PSTR("Enter Password:"));
   lcdSetCursor(lcd, 1, 0);
 
   // to prevent accidentally pressing enter or back
-  _delay_ms(750);
+  waitMs(750);
 
-  seconds = 0;
-  timeoutFlag = 0;
+  armTimeout();
   while (!(timeoutFlag)) {
-    input = getKeypad();
-    _delay_ms(100);
+    input = readKey();
 
     if (input == UP) {
-      if (strlen(passBuffer) < PASSWORD_LENGTH) {
+      if (strlen(entered) < PASSWORD_LENGTH) {
         // input is 1
-        snprintf(passBuffer + strlen(passBuffer),
-                 sizeof(passBuffer + strlen(passBuffer)), "%d", 1);
+        snprintf_P(entered + strlen(entered), sizeof(entered + strlen(entered)),
+                   PSTR("%d"), 1);
 
         // update the screen
         lcdClear(lcd);
         lcdSetCursor(lcd, 0, 0);
-        lcdPrint(lcd, "Enter Password:");
+        lcdPrint_P(lcd, PSTR("Enter Password:"));
         lcdSetCursor(lcd, 1, 0);
-        lcdPrint(lcd, passBuffer);
+        lcdPrint(lcd, entered);
       }
     } else if (input == DOWN) {
-      if (strlen(passBuffer) < PASSWORD_LENGTH) {
+      if (strlen(entered) < PASSWORD_LENGTH) {
         // input is 2
-        snprintf(passBuffer + strlen(passBuffer),
-                 sizeof(passBuffer + strlen(passBuffer)), "%d", 2);
+        snprintf_P(entered + strlen(entered), sizeof(entered + strlen(entered)),
+                   PSTR("%d"), 2);
 
         // update the screen
         lcdClear(lcd);
         lcdSetCursor(lcd, 0, 0);
-        lcdPrint(lcd, "Enter Password:");
+        lcdPrint_P(lcd, PSTR("Enter Password:"));
         lcdSetCursor(lcd, 1, 0);
-        lcdPrint(lcd, passBuffer);
+        lcdPrint(lcd, entered);
       }
     } else if (input == ENTER) {
-      if (strlen(passBuffer) == PASSWORD_LENGTH) {
-        if (strcmp(passBuffer, vars.password) == 0) {
+      if (strlen(entered) == PASSWORD_LENGTH) {
+        if (strcmp(entered, vars.password) == 0) {
           currentState = MENU;
           lastState = PASS;
         } else {
-          displayFailure("Incorrect Pass");
+          LOG_WARN("wrong password");
+          displayFailure(PSTR("Incorrect Pass"));
           currentState = STATUS;
           lastState = PASS;
         }
       } else {
-        displayFailure("Incorrect Pass");
+        displayFailure(PSTR("Incorrect Pass"));
         currentState = STATUS;
         lastState = PASS;
       }
@@ -278,80 +477,102 @@ void passwordHandler() {
   }
 }
 
-void displayFailure(char *msg) {
-  lcdClear(lcd);
-  lcdSetCursor(lcd, 0, 0);
-  snprintf(buffer, BUFFER_SIZE, "%s", msg);
-  lcdPrint(lcd, buffer);
-  _delay_ms(1000);
+void displayFailure(const char *msg) {
+  patternPlay(PATTERN_ERROR);
+  displayMessage(msg);
 }
 
-void displaySuccess(char *msg) {
+void displaySuccess(const char *msg) { displayMessage(msg); }
+
+void displayMessage(const char *msg) {
   lcdClear(lcd);
-  lcdSetCursor(lcd, 0, 0);
-  snprintf(buffer, BUFFER_SIZE, "%s", msg);
-  lcdPrint(lcd, buffer);
-  _delay_ms(1000);
+  if (strlen_P(msg) < BUFFER_SIZE) {
+    lcdSetCursor(lcd, 0, 0);
+    lcdPrint_P(lcd, msg);
+    waitMs(1000);
+    return;
+  }
+
+  // too long for a row, let the controller scroll it: the text is written
+  // once and every step is a single display-shift command
+  uint8_t length = lcdMarquee(lcd, 0, msg);
+  waitMs(1000);
+  for (uint8_t steps = length - (BUFFER_SIZE - 1); steps; steps--) {
+    waitMs(MARQUEE_STEP);
+    lcdMarqueeStep(lcd);
+  }
+  waitMs(1000);
+  lcdMarqueeStop(lcd);
 }
 
 void changePassword() {
-  passBuffer[0] = '\0';
+  char *entered = scratch.pass.entered;
   Input input;
 
   lcdClear(lcd);
   lcdSetCursor(lcd, 0, 0);
-  snprintf(buffer, BUFFER_SIZE, "Old Pass:%s", vars.password);
-  lcdPrint(lcd, buffer);
+  snprintf_P(scratch.line, BUFFER_SIZE, PSTR("Old Pass:%s"), vars.password);
+  lcdPrint(lcd, scratch.line);
   lcdSetCursor(lcd, 1, 0);
-  snprintf(buffer, BUFFER_SIZE, "New Pass:%s", passBuffer);
-  lcdPrint(lcd, buffer);
+  snprintf_P(scratch.line, BUFFER_SIZE, PSTR("New Pass:%s"), entered);
+  lcdPrint(lcd, scratch.line);
 
   // to prevent accidentally pressing enter or back
-  _delay_ms(750);
+  waitMs(750);
 
-  seconds = 0;
-  timeoutFlag = 0;
+  armTimeout();
   while (!(timeoutFlag)) {
-    input = getKeypad();
-    _delay_ms(100);
+    input = readKey();
 
     if (input == UP) {
-      if (strlen(passBuffer) < PASSWORD_LENGTH) {
+      if (strlen(entered) < PASSWORD_LENGTH) {
         // input is 1
-        snprintf(passBuffer + strlen(passBuffer),
-                 sizeof(passBuffer + strlen(passBuffer)), "%d", 1);
+        snprintf_P(entered + strlen(entered), sizeof(entered + strlen(entered)),
+                   PSTR("%d"), 1);
         lcdClear(lcd);
         lcdSetCursor(lcd, 0, 0);
-        snprintf(buffer, BUFFER_SIZE, "Old Pass:%s", vars.password);
-        lcdPrint(lcd, buffer);
+        snprintf_P(scratch.line, BUFFER_SIZE, PSTR("Old Pass:%s"),
+                   vars.password);
+        lcdPrint(lcd, scratch.line);
         lcdSetCursor(lcd, 1, 0);
-        snprintf(buffer, BUFFER_SIZE, "New Pass:%s", passBuffer);
-        lcdPrint(lcd, buffer);
+        snprintf_P(scratch.line, BUFFER_SIZE, PSTR("New Pass:%s"), entered);
+        lcdPrint(lcd, scratch.line);
       }
     } else if (input == DOWN) {
-      if (strlen(passBuffer) < PASSWORD_LENGTH) {
+      if (strlen(entered) < PASSWORD_LENGTH) {
         // input is 2
-        snprintf(passBuffer + strlen(passBuffer),
-                 sizeof(passBuffer + strlen(passBuffer)), "%d", 2);
+        snprintf_P(entered + strlen(entered), sizeof(entered + strlen(entered)),
+                   PSTR("%d"), 2);
         lcdClear(lcd);
         lcdSetCursor(lcd, 0, 0);
-        snprintf(buffer, BUFFER_SIZE, "Old Pass:%s", vars.password);
-        lcdPrint(lcd, buffer);
+        snprintf_P(scratch.line, BUFFER_SIZE, PSTR("Old Pass:%s"),
+                   vars.password);
+        lcdPrint(lcd, scratch.line);
         lcdSetCursor(lcd, 1, 0);
-        snprintf(buffer, BUFFER_SIZE, "New Pass:%s", passBuffer);
-        lcdPrint(lcd, buffer);
+        snprintf_P(scratch.line, BUFFER_SIZE, PSTR("New Pass:%s"), entered);
+        lcdPrint(lcd, scratch.line);
       }
     } else if (input == ENTER) {
-      if (strlen(passBuffer) == PASSWORD_LENGTH) {
-        strcpy(vars.password, passBuffer);
+      if (strlen(entered) == PASSWORD_LENGTH) {
+        strcpy(vars.password, entered);
         // update EEPROM
-        eeprom_write_block((const void *)vars.password, (void *)0x08,
+        eeprom_write_block((const void *)vars.password, (void *)EEPROM_PASSWORD,
                            sizeof(vars.password));
-        displaySuccess("Pass Changed");
+        displaySuccess(PSTR("Pass Changed"));
         currentState = MENU;
         lastState = CHANGE_PASS;
         break;
       }
+      // too long for a row, it scrolls
+      displayFailure(PSTR("New Pass must be 4 digits"));
+      lcdClear(lcd);
+      lcdSetCursor(lcd, 0, 0);
+      snprintf_P(scratch.line, BUFFER_SIZE, PSTR("Old Pass:%s"), vars.password);
+      lcdPrint(lcd, scratch.line);
+      lcdSetCursor(lcd, 1, 0);
+      snprintf_P(scratch.line, BUFFER_SIZE, PSTR("New Pass:%s"), entered);
+      lcdPrint(lcd, scratch.line);
+      armTimeout();
     } else if (input == BACK) {
       currentState = MENU;
       lastState = CHANGE_PASS;
@@ -361,60 +582,61 @@ void changePassword() {
 }
 
 void changeTime() {
-  uint8_t timeBuffer[3];
+  ClockScratch *clock = &scratch.clock;
 
   lcdClear(lcd);
   lcdSetCursor(lcd, 0, 0);
-  lcdPrint(lcd, "Set Time:");
+  lcdPrint_P(lcd, PSTR("Set Time:"));
   lcdSetCursor(lcd, 1, 0);
-  snprintf(buffer, BUFFER_SIZE, "%02d:%02d:%02d", vars.time[0], vars.time[1],
-           vars.time[2]);
-  lcdPrint(lcd, buffer);
+  snprintf_P(scratch.line, BUFFER_SIZE, PSTR("%02d:%02d:%02d"), vars.time[0],
+             vars.time[1], vars.time[2]);
+  lcdPrint(lcd, scratch.line);
 
   // to prevent accidentally pressing enter or back
-  _delay_ms(750);
+  waitMs(750);
 
   for (int i = 0; i < 3; i++) {
-    timeBuffer[i] = vars.time[i];
+    clock->time[i] = vars.time[i];
   }
 
-  seconds = 0;
-  timeoutFlag = 0;
+  armTimeout();
   for (int i = 0; i < 3; i++) {
     while (!(timeoutFlag)) {
-      keyInput = getKeypad();
-      _delay_ms(100);
+      keyInput = readKey();
 
       if (keyInput == UP) {
-        timeBuffer[i]++;
+        clock->time[i]++;
         lcdClear(lcd);
         lcdSetCursor(lcd, 0, 0);
-        lcdPrint(lcd, "Set Time:");
+        lcdPrint_P(lcd, PSTR("Set Time:"));
         lcdSetCursor(lcd, 1, 0);
-        snprintf(buffer, BUFFER_SIZE, "%02d:%02d:%02d", timeBuffer[0],
-                 timeBuffer[1], timeBuffer[2]);
-        lcdPrint(lcd, buffer);
+        snprintf_P(scratch.line, BUFFER_SIZE, PSTR("%02d:%02d:%02d"),
+                   clock->time[0], clock->time[1], clock->time[2]);
+        lcdPrint(lcd, scratch.line);
 
       } else if (keyInput == DOWN) {
-        timeBuffer[i]--;
+        clock->time[i]--;
         lcdClear(lcd);
         lcdSetCursor(lcd, 0, 0);
-        lcdPrint(lcd, "Set Time:");
+        lcdPrint_P(lcd, PSTR("Set Time:"));
         lcdSetCursor(lcd, 1, 0);
-        snprintf(buffer, BUFFER_SIZE, "%02d:%02d:%02d", timeBuffer[0],
-                 timeBuffer[1], timeBuffer[2]);
-        lcdPrint(lcd, buffer);
+        snprintf_P(scratch.line, BUFFER_SIZE, PSTR("%02d:%02d:%02d"),
+                   clock->time[0], clock->time[1], clock->time[2]);
+        lcdPrint(lcd, scratch.line);
 
       } else if (keyInput == ENTER) {
         if (i == 2) {
           // if cursor is on last digit, enter means save changes
           for (int i = 0; i < 3; i++) {
-            vars.time[i] = timeBuffer[i];
+            vars.time[i] = clock->time[i];
           }
-          displaySuccess("Time Changed");
+          displaySuccess(PSTR("Time Changed"));
           // update EEPROM
-          eeprom_write_block((const void *)vars.time, (void *)0x02,
+          eeprom_write_block((const void *)vars.time, (void *)EEPROM_TIME,
                              sizeof(vars.time));
+#ifdef RTC_DS1307
+          rtcWrite(vars.time);
+#endif
         }
         break;
 
@@ -433,58 +655,56 @@ void changeTime() {
 }
 
 void setAlarm() {
-  uint8_t alarmBuffer[3];
+  ClockScratch *clock = &scratch.clock;
 
   lcdClear(lcd);
   lcdSetCursor(lcd, 0, 0);
-  lcdPrint(lcd, "Set Alarm:");
+  lcdPrint_P(lcd, PSTR("Set Alarm:"));
   lcdSetCursor(lcd, 1, 0);
-  snprintf(buffer, BUFFER_SIZE, "%02d:%02d:%02d", vars.alarm[0], vars.alarm[1],
-           vars.alarm[2]);
-  lcdPrint(lcd, buffer);
+  snprintf_P(scratch.line, BUFFER_SIZE, PSTR("%02d:%02d:%02d"), vars.alarm[0],
+             vars.alarm[1], vars.alarm[2]);
+  lcdPrint(lcd, scratch.line);
 
   // to prevent accidentally pressing enter or back
-  _delay_ms(750);
+  waitMs(750);
 
   for (int i = 0; i < 3; i++) {
-    alarmBuffer[i] = vars.alarm[i];
+    clock->time[i] = vars.alarm[i];
   }
 
-  seconds = 0;
-  timeoutFlag = 0;
+  armTimeout();
   for (int i = 0; i < 3; i++) {
     while (!(timeoutFlag)) {
-      keyInput = getKeypad();
-      _delay_ms(100);
+      keyInput = readKey();
 
       if (keyInput == UP) {
-        alarmBuffer[i]++;
+        clock->time[i]++;
         lcdClear(lcd);
         lcdSetCursor(lcd, 0, 0);
-        lcdPrint(lcd, "Set Alarm:");
+        lcdPrint_P(lcd, PSTR("Set Alarm:"));
         lcdSetCursor(lcd, 1, 0);
-        snprintf(buffer, BUFFER_SIZE, "%02d:%02d:%02d", alarmBuffer[0],
-                 alarmBuffer[1], alarmBuffer[2]);
-        lcdPrint(lcd, buffer);
+        snprintf_P(scratch.line, BUFFER_SIZE, PSTR("%02d:%02d:%02d"),
+                   clock->time[0], clock->time[1], clock->time[2]);
+        lcdPrint(lcd, scratch.line);
 
       } else if (keyInput == DOWN) {
-        alarmBuffer[i]--;
+        clock->time[i]--;
         lcdClear(lcd);
         lcdSetCursor(lcd, 0, 0);
-        lcdPrint(lcd, "Set Alarm:");
+        lcdPrint_P(lcd, PSTR("Set Alarm:"));
         lcdSetCursor(lcd, 1, 0);
-        snprintf(buffer, BUFFER_SIZE, "%02d:%02d:%02d", alarmBuffer[0],
-                 alarmBuffer[1], alarmBuffer[2]);
-        lcdPrint(lcd, buffer);
+        snprintf_P(scratch.line, BUFFER_SIZE, PSTR("%02d:%02d:%02d"),
+                   clock->time[0], clock->time[1], clock->time[2]);
+        lcdPrint(lcd, scratch.line);
 
       } else if (keyInput == ENTER) {
         if (i == 2) {
           for (int i = 0; i < 3; i++) {
-            vars.alarm[i] = alarmBuffer[i];
+            vars.alarm[i] = clock->time[i];
           }
-          displaySuccess("Alarm Changed");
+          displaySuccess(PSTR("Alarm Changed"));
           // update EEPROM
-          eeprom_write_block((const void *)vars.alarm, (void *)0x05,
+          eeprom_write_block((const void *)vars.alarm, (void *)EEPROM_ALARM,
                              sizeof(vars.alarm));
         }
         break;
@@ -505,44 +725,46 @@ void setAlarm() {
 }
 
 void changeSpeed() {
-  uint8_t tempSpeed = vars.maxSpeed;
+  ZoneScratch *zone = &scratch.zone;
 
-  lcdClear(lcd);
-  lcdSetCursor(lcd, 0, 0);
-  snprintf(buffer, BUFFER_SIZE, "Max Speed:%d", vars.maxSpeed);
-  lcdPrint(lcd, buffer);
+  // one zone after another, ENTER saves and moves on to the next zone
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    zone->value = zones.maxSpeed[z];
 
-  // to prevent accidentally pressing enter or back
-  _delay_ms(750);
+    lcdClear(lcd);
+    printZoneSetting(z, PSTR("Max Speed:%d"), zone->value);
 
-  seconds = 0;
-  timeoutFlag = 0;
-  while (!(timeoutFlag)) {
-    keyInput = getKeypad();
-    _delay_ms(100);
+    // to prevent accidentally pressing enter or back
+    waitMs(750);
 
-    if (keyInput == UP) {
-      tempSpeed++;
-      lcdClear(lcd);
-      lcdSetCursor(lcd, 0, 0);
-      snprintf(buffer, BUFFER_SIZE, "Max Speed:%d", tempSpeed);
-      lcdPrint(lcd, buffer);
+    armTimeout();
+    while (!(timeoutFlag)) {
+      keyInput = readKey();
 
-    } else if (keyInput == DOWN) {
-      tempSpeed--;
-      lcdClear(lcd);
-      lcdSetCursor(lcd, 0, 0);
-      snprintf(buffer, BUFFER_SIZE, "Max Speed:%d", tempSpeed);
-      lcdPrint(lcd, buffer);
+      if (keyInput == UP) {
+        zone->value++;
+        lcdClear(lcd);
+        printZoneSetting(z, PSTR("Max Speed:%d"), zone->value);
 
-    } else if (keyInput == ENTER) {
-      displaySuccess("Speed Changed");
-      vars.maxSpeed = tempSpeed;
-      // update EEPROM
-      eeprom_write_byte((uint8_t *)0x00, vars.maxSpeed);
-      break;
+      } else if (keyInput == DOWN) {
+        zone->value--;
+        lcdClear(lcd);
+        printZoneSetting(z, PSTR("Max Speed:%d"), zone->value);
 
-    } else if (keyInput == BACK) {
+      } else if (keyInput == ENTER) {
+        displaySuccess(PSTR("Speed Changed"));
+        zones.maxSpeed[z] = zone->value;
+        fanCompile();
+        // update EEPROM
+        eeprom_write_byte((uint8_t *)EEPROM_ZONE_MAX_SPEED(z), zone->value);
+        break;
+
+      } else if (keyInput == BACK) {
+        break;
+      }
+    }
+
+    if (keyInput != ENTER) {
       break;
     }
   }
@@ -552,152 +774,319 @@ void changeSpeed() {
 }
 
 void changeTemp() {
-  uint8_t tempTemp = vars.tempThreshold;
+  ZoneScratch *zone = &scratch.zone;
+
+  // one zone after another, ENTER saves and moves on to the next zone
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    zone->value = zones.tempThreshold[z];
+
+    lcdClear(lcd);
+    printZoneSetting(z, PSTR("Thresh(C):%d"), zone->value);
+
+    // to prevent accidentally pressing enter or back
+    waitMs(750);
+
+    armTimeout();
+    while (!(timeoutFlag)) {
+      keyInput = readKey();
+
+      if (keyInput == UP) {
+        zone->value++;
+        lcdClear(lcd);
+        printZoneSetting(z, PSTR("Thresh(C):%d"), zone->value);
+
+      } else if (keyInput == DOWN) {
+        zone->value--;
+        lcdClear(lcd);
+        printZoneSetting(z, PSTR("Thresh(C):%d"), zone->value);
+
+      } else if (keyInput == ENTER) {
+        zones.tempThreshold[z] = zone->value;
+        // update EEPROM
+        eeprom_write_byte((uint8_t *)EEPROM_ZONE_THRESHOLD(z), zone->value);
+        displaySuccess(PSTR("Temp Changed"));
+        break;
+
+      } else if (keyInput == BACK) {
+        break;
+      }
+    }
+
+    if (keyInput != ENTER) {
+      break;
+    }
+  }
+
+  currentState = MENU;
+  lastState = CHANGE_TEMP;
+}
 
+void changeCurve() {
+  CurveScratch *edit = &scratch.curve;
+
+  memcpy(edit->curve, fanCurve, sizeof(edit->curve));
   lcdClear(lcd);
+  drawCurvePoint(0, edit->curve[0].temp, edit->curve[0].duty, 0);
+
+  // to prevent accidentally pressing enter or back
+  waitMs(750);
+
+  armTimeout();
+  while (!(timeoutFlag)) {
+    keyInput = readKey();
+    uint8_t i = edit->field / 2;
+
+    if (keyInput == UP || keyInput == DOWN) {
+      int8_t step = keyInput == UP ? 1 : -1;
+
+      if (edit->field % 2 == 0) {
+        // keep the temperatures in increasing order
+        uint8_t min = i ? edit->curve[i - 1].temp + 1 : MIN_TEMP;
+        uint8_t max =
+            i < FAN_CURVE_POINTS - 1 ? edit->curve[i + 1].temp - 1 : MAX_TEMP;
+        if (edit->curve[i].temp + step >= min &&
+            edit->curve[i].temp + step <= max) {
+          edit->curve[i].temp += step;
+        }
+      } else if (edit->curve[i].duty + step >= MIN_SPEED &&
+                 edit->curve[i].duty + step <= MAX_SPEED) {
+        edit->curve[i].duty += step;
+      }
+
+    } else if (keyInput == ENTER) {
+      if (edit->field == FAN_CURVE_POINTS * 2 - 1) {
+        // ENTER on the last duty saves the curve
+        memcpy(fanCurve, edit->curve, sizeof(edit->curve));
+        fanSave();
+        displaySuccess(PSTR("Curve Changed"));
+        break;
+      }
+      edit->field++;
+
+    } else if (keyInput == BACK) {
+      if (edit->field == 0) {
+        break;
+      }
+      edit->field--;
+
+    } else {
+      continue;
+    }
+
+    i = edit->field / 2;
+    lcdClear(lcd);
+    drawCurvePoint(i, edit->curve[i].temp, edit->curve[i].duty,
+                   edit->field % 2);
+  }
+
+  currentState = MENU;
+  lastState = CHANGE_CURVE;
+}
+
+void drawCurvePoint(uint8_t point, uint8_t temp, uint8_t duty, uint8_t field) {
+  lcdSetCursor(lcd, 0, 0);
+  snprintf_P(scratch.line, BUFFER_SIZE, PSTR("Fan Curve %d/%d"), point + 1,
+             FAN_CURVE_POINTS);
+  lcdPrint(lcd, scratch.line);
+  lcdSetCursor(lcd, 1, 0);
+  snprintf_P(scratch.line, BUFFER_SIZE, PSTR("%cTemp:%dC %c%d%%"),
+             field ? ' ' : '>', temp, field ? '>' : ' ', duty);
+  lcdPrint(lcd, scratch.line);
+}
+
+void printZoneSetting(uint8_t zone, const char *fmt, uint8_t value) {
   lcdSetCursor(lcd, 0, 0);
-  snprintf(buffer, BUFFER_SIZE, "Thresh(C):%d", vars.tempThreshold);
-  lcdPrint(lcd, buffer);
+#if ZONE_COUNT > 1
+  // prefix the zone number
+  snprintf_P(scratch.line, BUFFER_SIZE, PSTR("Z%d "), zone + 1);
+  lcdPrint(lcd, scratch.line);
+#endif
+  snprintf_P(scratch.line, BUFFER_SIZE, fmt, value);
+  lcdPrint(lcd, scratch.line);
+}
+
+void displayStats() {
+  StatsScratch *stats = &scratch.stats;
+
+  stats->window = STATS_MINUTE;
+  drawStats(stats->window);
 
   // to prevent accidentally pressing enter or back
-  _delay_ms(750);
+  waitMs(750);
 
-  seconds = 0;
-  timeoutFlag = 0;
+  armTimeout();
   while (!(timeoutFlag)) {
-    keyInput = getKeypad();
-    _delay_ms(100);
+    keyInput = readKey();
 
     if (keyInput == UP) {
-      tempTemp++;
-      lcdClear(lcd);
-      lcdSetCursor(lcd, 0, 0);
-      snprintf(buffer, BUFFER_SIZE, "Thresh(C):%d", tempTemp);
-      lcdPrint(lcd, buffer);
+      // previous window
+      stats->window = (stats->window + STATS_WINDOWS - 1) % STATS_WINDOWS;
+      drawStats(stats->window);
+      stats->refresh = 0;
 
     } else if (keyInput == DOWN) {
-      tempTemp--;
-      lcdClear(lcd);
-      lcdSetCursor(lcd, 0, 0);
-      snprintf(buffer, BUFFER_SIZE, "Thresh(C):%d", tempTemp);
-      lcdPrint(lcd, buffer);
+      // next window
+      stats->window = (stats->window + 1) % STATS_WINDOWS;
+      drawStats(stats->window);
+      stats->refresh = 0;
 
-    } else if (keyInput == ENTER) {
-      vars.tempThreshold = tempTemp;
-      // update EEPROM
-      eeprom_write_byte((uint8_t *)0x01, vars.tempThreshold);
-      displaySuccess("Temp Changed");
+    } else if (keyInput == ENTER || keyInput == BACK) {
       break;
 
-    } else if (keyInput == BACK) {
-      break;
+    } else if (++stats->refresh == 10) {
+      // pick up new samples every second
+      drawStats(stats->window);
+      stats->refresh = 0;
     }
   }
 
   currentState = MENU;
-  lastState = CHANGE_TEMP;
+  lastState = STATS;
 }
 
-void displayMenu() {
-  int menuIndex = 0;
+void drawStats(uint8_t window) {
+  static const char labels[STATS_WINDOWS][4] PROGMEM = {"1m", "1h", "24h"};
+  Summary temp, duty;
 
-  // fill menu items with spaces
-  for (int i = 0; i < 5; i++) {
-    filler(menu[i], BUFFER_SIZE, ' ');
-  }
-
-  // print first line
   lcdClear(lcd);
   lcdSetCursor(lcd, 0, 0);
-  addCursor(menu[menuIndex]);
-  lcdPrint(lcd, menu[menuIndex]);
-  // print second line
-  lcdSetCursor(lcd, 1, 0);
-  lcdPrint(lcd, menu[(menuIndex + 1) % MENU_ITEMS]);
+  if (statsGet(STATS_TEMP, window, &temp) &&
+      statsGet(STATS_DUTY, window, &duty)) {
+    // min/avg/max
+    snprintf_P(scratch.line, BUFFER_SIZE, PSTR("%-4S%d/%d/%dC"), labels[window],
+               temp.min, temp.avg, temp.max);
+    lcdPrint(lcd, scratch.line);
+    lcdSetCursor(lcd, 1, 0);
+    snprintf_P(scratch.line, BUFFER_SIZE, PSTR("Fan %d/%d/%d%%"), duty.min,
+               duty.avg, duty.max);
+    lcdPrint(lcd, scratch.line);
+  } else {
+    snprintf_P(scratch.line, BUFFER_SIZE, PSTR("%-4Sno data"), labels[window]);
+    lcdPrint(lcd, scratch.line);
+  }
+}
+
+void displayMenu() {
+  uint8_t state;
+
+  // start at the top, unless we're back from one of the editors (after a
+  // warm restart into an editor the menu was never opened)
+  if (lastState == PASS || lastState == NOSTATE || !menuIsOpen()) {
+    menuOpen(mainMenu, MENU_SIZE(mainMenu));
+  }
+  menuDraw(lcd);
 
   // to prevent accidentally pressing enter or back
-  _delay_ms(750);
+  waitMs(750);
 
-  seconds = 0;
-  timeoutFlag = 0;
+  armTimeout();
   while (!(timeoutFlag)) {
-    keyInput = getKeypad();
-    _delay_ms(100);
+    keyInput = readKey();
 
-    if (keyInput == UP) {
-      lcdClear(lcd);
-      removeCursor(menu[menuIndex]);
-      lcdSetCursor(lcd, 1, 0);
-      lcdPrint(lcd, menu[menuIndex]);
+    switch (menuKey(lcd, keyInput, &state)) {
+    case MENU_EDIT:
+      currentState = state;
+      lastState = MENU;
+      return;
 
-      addCursor(menu[(menuIndex + MENU_ITEMS - 1) % MENU_ITEMS]);
-      lcdSetCursor(lcd, 0, 0);
-      lcdPrint(lcd, menu[(menuIndex + MENU_ITEMS - 1) % MENU_ITEMS]);
+    case MENU_EXIT:
+      currentState = STATUS;
+      lastState = MENU;
+      return;
 
-      menuIndex--;
-      // set lowerboundary
-      if (menuIndex == -1) {
-        menuIndex = 4;
+    case MENU_DONE:
+      if (currentState != MENU) {
+        return;
       }
+      break;
 
-    } else if (keyInput == DOWN) {
-      lcdClear(lcd);
-      removeCursor(menu[menuIndex]);
-      lcdSetCursor(lcd, 0, 0);
-      lcdPrint(lcd, menu[menuIndex]);
+    case MENU_NONE:
+      break;
+    }
+  }
+}
 
-      addCursor(menu[(menuIndex + 1) % MENU_ITEMS]);
-      lcdSetCursor(lcd, 1, 0);
-      lcdPrint(lcd, menu[(menuIndex + 1) % MENU_ITEMS]);
+void lock() {
+  currentState = STATUS;
+  lastState = MENU;
+}
 
-      menuIndex++;
-      // set upper boundary
-      if (menuIndex == 5) {
-        menuIndex = 0;
-      }
+void handleEvents() {
+  Event event;
 
-    } else if (keyInput == ENTER) {
-      removeCursor(menu[menuIndex]);
+  while (eventPoll(&event)) {
+    switch (event.type) {
+    case EVENT_TICK:
+      secondTick();
+      break;
 
-      switch (menuIndex + 4) {
-      case CHANGE_PASS:
-        currentState = CHANGE_PASS;
-        lastState = MENU;
-        break;
-      case CHANGE_TEMP:
-        currentState = CHANGE_TEMP;
-        lastState = MENU;
-        break;
-      case CHANGE_SPEED:
-        currentState = CHANGE_SPEED;
-        lastState = MENU;
-        break;
-      case CHANGE_TIME:
-        currentState = CHANGE_TIME;
-        lastState = MENU;
-        break;
-      case SET_ALARM:
-        currentState = SET_ALARM;
-        lastState = MENU;
+    case EVENT_KEY_WAKE:
+#ifdef TRACE_RECORD
+      traceKey();
+#endif
+      // a key snoozes a ringing alarm
+      if (patternActive(PATTERN_ALARM)) {
+        patternStop(PATTERN_ALARM);
         break;
       }
+      // a key that only woke the display up is ignored
+      if (!event.data && currentState == STATUS) {
+        currentState = PASS;
+        lastState = STATUS;
+      }
       break;
+    }
+  }
+}
 
-    } else if (keyInput == BACK) {
-      removeCursor(menu[menuIndex]);
-
-      currentState = STATUS;
-      lastState = MENU;
-      break;
+void secondTick() {
+  // emulate an RTC, the RTC driver may write the time from its interrupt
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    vars.time[2]++;
+    if (vars.time[2] == 60) {
+      vars.time[2] = 0;
+      vars.time[1]++;
     }
+    if (vars.time[1] == 60) {
+      vars.time[1] = 0;
+      vars.time[0]++;
+    }
+  }
+
+  // check if the alarm has went off
+  checkAlarm();
+
+  // rolling statistics of the first zone
+  statsSample(zones.currentTemp[0], zones.speed[0]);
+
+  // keep the warm restart copy of the clock up to date
+  bootSave(&vars, &zones, currentState);
+}
+
+Input readKey() {
+  Input key = getKeypad();
+
+  if (key != NOINPUT) {
+    patternPlay(PATTERN_CLICK);
   }
+  waitMs(KEY_POLL);
+  return key;
 }
 
 void checkAlarm() {
   if (memcmp(vars.time, vars.alarm, sizeof(vars.time)) == 0) {
-    PORTD |= (1 << PORTD0);
-  } else {
-    PORTD &= ~(1 << PORTD0);
+    alarmRounds = ALARM_REPEATS;
+    alarmSnooze = 1;
+  }
+
+  // ring again ALARM_SNOOZE seconds after it was snoozed or rang out
+  if (alarmRounds && !alarmSnooze && !patternActive(PATTERN_ALARM)) {
+    alarmSnooze = ALARM_SNOOZE;
+  }
+  if (alarmSnooze && --alarmSnooze == 0) {
+    alarmRounds--;
+    LOG_INFO("alarm, %u more rounds", alarmRounds);
+    patternPlay(PATTERN_ALARM);
   }
 }
 
@@ -712,10 +1101,9 @@ void timerInit() {
   TCCR1B |= (1 << WGM12);
   // Set prescaler to 1024
   TCCR1B |= (1 << CS12) | (1 << CS10);
-  // Calculate OCR1A value for 30 seconds
+  // Calculate OCR1A value for 1 second
   // OCR1A = (F_CPU * time_in_seconds) / prescaler - 1
-  // OCR1A = (16000000 * 1) / 1024 - 1 = 15624
-  OCR1A = 15624;
+  OCR1A = SECOND_RELOAD;
 }
 
 void startTimer() {
@@ -0,0 +1,130 @@
+#include "../include/menu.h"
+#include "../include/lcd.h"
+#include "../include/util.h"
+#include <avr/pgmspace.h>
+#include <inttypes.h>
+#include <string.h>
+
+typedef struct {
+  const MenuNode *nodes;
+  uint8_t count;
+  uint8_t index; // item under the cursor
+  uint8_t top;   // item on the first row
+} Level;
+
+static Level levels[MENU_DEPTH];
+static uint8_t depth = 0;
+
+// draw an item, or blank if it's past the end, on a row
+static void drawRow(LCD lcd, uint8_t row);
+
+// draw or erase the "<<" cursor on a row, the rest of the row is kept
+static void drawCursor(LCD lcd, uint8_t row, uint8_t on);
+
+// move the cursor, scroll only if the item isn't on the screen
+static void moveCursor(LCD lcd, uint8_t index);
+
+void menuOpen(const MenuNode *nodes, uint8_t count) {
+  depth = 0;
+  levels[0] = (Level){nodes, count, 0, 0};
+}
+
+uint8_t menuIsOpen() { return levels[0].nodes != NULL; }
+
+void menuDraw(LCD lcd) {
+  for (uint8_t row = 0; row < MENU_ROWS; row++) {
+    drawRow(lcd, row);
+  }
+}
+
+MenuEvent menuKey(LCD lcd, Input key, uint8_t *state) {
+  Level *level = &levels[depth];
+  MenuNode node;
+
+  if (!level->count && key != BACK) {
+    return MENU_NONE;
+  }
+
+  switch (key) {
+  case UP:
+    moveCursor(lcd, level->index ? level->index - 1 : level->count - 1);
+    break;
+
+  case DOWN:
+    moveCursor(lcd, (level->index + 1) % level->count);
+    break;
+
+  case ENTER:
+    memcpy_P(&node, &level->nodes[level->index], sizeof(node));
+    switch (node.type) {
+    case NODE_SUBMENU:
+      if (depth + 1 < MENU_DEPTH) {
+        depth++;
+        levels[depth] = (Level){node.children, node.count, 0, 0};
+        menuDraw(lcd);
+      }
+      break;
+
+    case NODE_ACTION:
+      node.action();
+      return MENU_DONE;
+
+    case NODE_EDITOR:
+      *state = node.state;
+      return MENU_EDIT;
+    }
+    break;
+
+  case BACK:
+    if (depth == 0) {
+      return MENU_EXIT;
+    }
+    depth--;
+    menuDraw(lcd);
+    break;
+
+  case NOINPUT:
+    break;
+  }
+
+  return MENU_NONE;
+}
+
+static void drawRow(LCD lcd, uint8_t row) {
+  const Level *level = &levels[depth];
+  uint8_t index = level->top + row;
+  char text[MENU_COLS + 1];
+
+  if (index < level->count) {
+    strcpy_P(text, level->nodes[index].label);
+  } else {
+    text[0] = '\0';
+  }
+  filler(text, sizeof(text), ' ');
+  if (index == level->index) {
+    addCursor(text);
+  }
+  lcdSetCursor(lcd, row, 0);
+  lcdPrint(lcd, text);
+}
+
+static void drawCursor(LCD lcd, uint8_t row, uint8_t on) {
+  lcdSetCursor(lcd, row, MENU_COLS - 2);
+  lcdPrint_P(lcd, on ? PSTR("<<") : PSTR("  "));
+}
+
+static void moveCursor(LCD lcd, uint8_t index) {
+  Level *level = &levels[depth];
+  uint8_t last = level->index;
+
+  level->index = index;
+  if (index >= level->top && index < level->top + MENU_ROWS) {
+    // both items are on the screen, only the cursor cells change
+    drawCursor(lcd, last - level->top, 0);
+    drawCursor(lcd, index - level->top, 1);
+  } else {
+    // scroll so the item shows up on the edge the cursor moved through
+    level->top = index < level->top ? index : index - (MENU_ROWS - 1);
+    menuDraw(lcd);
+  }
+}
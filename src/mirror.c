@@ -0,0 +1,133 @@
+#include "../include/mirror.h"
+#include "../include/uart.h"
+#include "../include/wheel.h"
+#include <inttypes.h>
+#include <string.h>
+
+_Static_assert(PROTO_LCD_COLS == LCD_DDRAM_COLS, "mirror geometry mismatch");
+
+static uint8_t ddram[MIRROR_CELLS]; // what the controller holds
+static uint8_t sent[MIRROR_CELLS];  // what the host was sent
+static uint8_t address = 0;         // cell written next
+static uint8_t shift = 0;           // columns scrolled to the left
+static uint8_t control = 0;         // LCD_DISPLAYCONTROL flags
+static uint8_t sentShift = 0;
+static uint8_t sentControl = 0;
+static uint8_t updates = 0; // since the last keyframe
+static Timer mirrorTimer;
+
+// send the changes as far as the TX buffer has room, the rest waits for the
+// next update (mirrorTimer callback)
+static void update();
+
+// fill a frame with the changed cells, returns its payload length or 0 if
+// there's nothing to send
+static uint8_t pack(uint8_t *payload);
+
+// mark everything as unsent so a host that attaches late gets the whole
+// screen
+static void keyframe();
+
+void mirrorInit() {
+  // the contents are unknown after a warm reset until they're redrawn
+  memset(ddram, ' ', sizeof(ddram));
+  keyframe();
+  timerArm(&mirrorTimer, MIRROR_PERIOD, MIRROR_PERIOD, update);
+}
+
+void mirrorCommand(uint8_t cmd) {
+  if (cmd & LCD_SETDDRAMADDR) {
+    // rows start at 0x00 and 0x40, nothing is stored past column 39
+    uint8_t col = cmd & 0x3F;
+    address = (col < PROTO_LCD_COLS) ? col : MIRROR_CELLS;
+    if (address < MIRROR_CELLS && (cmd & 0x40)) {
+      address += PROTO_LCD_COLS;
+    }
+  } else if (cmd & (LCD_SETCGRAMADDR | LCD_FUNCTIONSET)) {
+    // custom characters and the interface setup don't show
+  } else if (cmd & LCD_CURSORSHIFT) {
+    uint8_t right = cmd & LCD_MOVERIGHT;
+    if (cmd & LCD_DISPLAYMOVE) {
+      // moving the display left scrolls the contents in from the right
+      shift = (shift + (right ? PROTO_LCD_COLS - 1 : 1)) % PROTO_LCD_COLS;
+    } else if (address < MIRROR_CELLS) {
+      address = (address + (right ? 1 : MIRROR_CELLS - 1)) % MIRROR_CELLS;
+    }
+  } else if (cmd & LCD_DISPLAYCONTROL) {
+    control = cmd & (LCD_DISPLAYON | LCD_CURSORON | LCD_BLINKON);
+  } else if (cmd & LCD_ENTRYMODESET) {
+    // the driver always writes left to right
+  } else if (cmd & LCD_RETURNHOME) {
+    address = 0;
+    shift = 0;
+  } else if (cmd & LCD_CLEARDISPLAY) {
+    memset(ddram, ' ', sizeof(ddram));
+    address = 0;
+    shift = 0;
+  }
+}
+
+void mirrorData(uint8_t data) {
+  if (address >= MIRROR_CELLS) {
+    return;
+  }
+  ddram[address] = data;
+  // the end of the first row runs into the second and back
+  address = (address + 1) % MIRROR_CELLS;
+}
+
+static void update() {
+  uint8_t payload[PROTO_MAX_PAYLOAD];
+  uint8_t len;
+
+  if (++updates >= MIRROR_KEYFRAME) {
+    updates = 0;
+    keyframe();
+  }
+
+  // a frame is only built when it fits, so the main loop never waits
+  while (uartFree() >= PROTO_MAX_PAYLOAD + 5 && (len = pack(payload))) {
+    protoSend(PROTO_LCD, payload, len);
+  }
+}
+
+static uint8_t pack(uint8_t *payload) {
+  uint8_t len = 2;
+
+  payload[0] = shift;
+  payload[1] = control;
+  for (uint8_t cell = 0; cell < MIRROR_CELLS; cell++) {
+    if (ddram[cell] == sent[cell]) {
+      continue;
+    }
+    // room for the cell, the count and at least one character
+    if (len + 3 > PROTO_MAX_PAYLOAD) {
+      break;
+    }
+    uint8_t *run = &payload[len];
+    run[0] = cell;
+    run[1] = 0;
+    len += 2;
+    while (cell < MIRROR_CELLS && ddram[cell] != sent[cell] &&
+           len < PROTO_MAX_PAYLOAD) {
+      payload[len++] = sent[cell] = ddram[cell];
+      run[1]++;
+      cell++;
+    }
+  }
+
+  if (len == 2 && shift == sentShift && control == sentControl) {
+    return 0;
+  }
+  sentShift = shift;
+  sentControl = control;
+  return len;
+}
+
+static void keyframe() {
+  for (uint8_t cell = 0; cell < MIRROR_CELLS; cell++) {
+    sent[cell] = ~ddram[cell];
+  }
+  sentShift = ~shift;
+  sentControl = ~control;
+}
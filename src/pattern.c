@@ -0,0 +1,147 @@
+#include "../include/pattern.h"
+#include "../include/board.h"
+#include "../include/wheel.h"
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <inttypes.h>
+
+static const Step clickSteps[] PROGMEM = {
+    {PATTERN_BUZZER, 2},
+    {0, 0},
+};
+static const Step errorSteps[] PROGMEM = {
+    {PATTERN_BUZZER | PATTERN_LED, 15},
+    {0, 10},
+    {PATTERN_BUZZER | PATTERN_LED, 15},
+    {0, 10},
+    {PATTERN_BUZZER | PATTERN_LED, 40},
+    {0, 0},
+};
+static const Step trendSteps[] PROGMEM = {
+    {PATTERN_LED, 5},
+    {0, 195},
+    {0, 0},
+};
+static const Step overTempSteps[] PROGMEM = {
+    {PATTERN_BUZZER | PATTERN_LED, 5},
+    {PATTERN_LED, 45},
+    {0, 150},
+    {0, 0},
+};
+static const Step alarmSteps[] PROGMEM = {
+    {PATTERN_BUZZER | PATTERN_LED, 10},
+    {0, 10},
+    {PATTERN_BUZZER | PATTERN_LED, 10},
+    {0, 10},
+    {PATTERN_BUZZER | PATTERN_LED, 10},
+    {0, 50},
+    {0, 0},
+};
+
+static const PatternDef patterns[PATTERNS] PROGMEM = {
+    [PATTERN_CLICK] = {clickSteps, 1},
+    [PATTERN_ERROR] = {errorSteps, 1},
+    [PATTERN_TREND] = {trendSteps, 0},
+    [PATTERN_OVERTEMP] = {overTempSteps, 0},
+    [PATTERN_ALARM] = {alarmSteps, 30}, // 30s
+};
+
+static uint8_t requested = 0;      // bit per requested pattern
+static Pattern playing = PATTERNS; // PATTERNS if nothing is playing
+static PatternDef current;         // definition of the playing pattern
+static const Step *step;           // next step
+static uint8_t repeats;            // plays left, 0 until stopped
+static Timer stepTimer;
+
+// play the most important requested pattern
+static void select();
+
+// output the next step and wait for it to end (stepTimer callback)
+static void advance();
+
+// drive the buzzer and the LED
+static void setOutputs(uint8_t outputs);
+
+void patternInit() {
+  BOARD_BUZZER_DDR |= (1 << BOARD_BUZZER_BIT);
+  BOARD_LED_DDR |= (1 << BOARD_LED_BIT);
+  setOutputs(0);
+}
+
+void patternPlay(Pattern pattern) {
+  if (playing != PATTERNS && playing > pattern &&
+      pgm_read_byte(&patterns[pattern].repeat)) {
+    return;
+  }
+  requested |= (1 << pattern);
+  select();
+}
+
+void patternStop(Pattern pattern) {
+  requested &= ~(1 << pattern);
+  select();
+}
+
+uint8_t patternActive(Pattern pattern) {
+  return (requested & (1 << pattern)) != 0;
+}
+
+static void select() {
+  Pattern next = PATTERNS;
+
+  while (next > 0 && !(requested & (1 << (next - 1)))) {
+    next--;
+  }
+  next = next ? next - 1 : PATTERNS;
+  if (next == playing) {
+    return;
+  }
+
+  // a preempted pattern that doesn't play until stopped is dropped
+  if (playing != PATTERNS && current.repeat) {
+    requested &= ~(1 << playing);
+  }
+  playing = next;
+  if (playing == PATTERNS) {
+    timerCancel(&stepTimer);
+    setOutputs(0);
+    return;
+  }
+  memcpy_P(&current, &patterns[playing], sizeof(current));
+  step = current.steps;
+  repeats = current.repeat;
+  advance();
+}
+
+static void advance() {
+  Step next;
+
+  memcpy_P(&next, step, sizeof(next));
+  if (next.time == 0) {
+    if (repeats && --repeats == 0) {
+      // done, give the turn to the next pattern
+      requested &= ~(1 << playing);
+      select();
+      return;
+    }
+    step = current.steps;
+    memcpy_P(&next, step, sizeof(next));
+  }
+
+  setOutputs(next.outputs);
+  step++;
+  timerArm(&stepTimer, next.time * PATTERN_TICK, 0, advance);
+}
+
+static void setOutputs(uint8_t outputs) {
+  if (outputs & PATTERN_BUZZER) {
+    BOARD_BUZZER_PORT |= (1 << BOARD_BUZZER_BIT);
+  } else {
+    BOARD_BUZZER_PORT &= ~(1 << BOARD_BUZZER_BIT);
+  }
+  if (outputs & PATTERN_LED) {
+    BOARD_LED_PORT |= (1 << BOARD_LED_BIT);
+  } else {
+    BOARD_LED_PORT &= ~(1 << BOARD_LED_BIT);
+  }
+}
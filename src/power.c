@@ -0,0 +1,194 @@
+#include "../include/power.h"
+#include "../include/adc.h"
+#include "../include/board.h"
+#include "../include/fan.h"
+#include "../include/log.h"
+#include "../include/main.h"
+#include "../include/util.h"
+#include "../include/wheel.h"
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
+
+extern Vars vars;
+extern Zones zones;
+extern State currentState;
+extern const uint8_t zoneFan[ZONE_COUNT];
+
+// ADC conversion time, 13 ADC clocks at F_CPU / 128 (adcInit())
+#define CONVERSION_US (13 * 128 * 1000000UL / F_CPU)
+
+// the failure has to be noticed and the whole checkpoint written before the
+// supply runs out. the ISR doesn't wait for the main loop, only for an ADC
+// conversion and an EEPROM write it started, and other ISRs are short
+_Static_assert(POWER_POLL * POWER_SAMPLES * 1000UL + 4 * CONVERSION_US +
+                       (sizeof(Checkpoint) + 1) * (uint32_t)EEPROM_WRITE_US <=
+                   POWER_HOLDUP_MS * 1000UL,
+               "checkpoint doesn't fit in the hold-up time");
+_Static_assert(EEPROM_FAN_CURVE + sizeof(fanCurve) <= EEPROM_CHECKPOINT,
+               "fan curve overlaps the checkpoint in EEPROM");
+
+// ADC readings of the bandgap against AVCC, higher means a lower supply
+#define ADC_BANDGAP BOARD_ADC_BANDGAP
+#define READING(bandgap, mv) ((uint32_t)(bandgap) * 1024 / (mv))
+
+static Timer reportTimer;
+static uint16_t failReading;          // bandgap reading at POWER_FAIL_MV
+static uint16_t okReading;            // and at POWER_OK_MV
+static uint8_t pollMs = 0;            // ms since the last measurement
+static uint8_t lowCount = 0;          // low measurements in a row
+static volatile uint8_t saved = 0;    // checkpoint written, not recovered
+static volatile uint16_t lastReading; // of the last change of saved
+static uint8_t reported = 0;          // saved as last logged
+
+// log the checkpoints and recoveries of the ISR (reportTimer callback)
+static void report();
+
+// shed the fans and write the checkpoint to EEPROM
+static void checkpoint();
+
+// make the checkpoint in EEPROM invalid
+static void invalidate();
+
+// CRC of a checkpoint, up to its crc field
+static uint16_t checkpointCrc(const Checkpoint *data);
+
+void powerInit() {
+  // the bandgap as measured against the nominal supply, kept within the
+  // datasheet range in case the supply is already off at boot
+  adcRead(ADC_BANDGAP);
+  uint16_t bandgap = (uint32_t)adcRead(ADC_BANDGAP) * POWER_NOMINAL_MV / 1024;
+  if (bandgap < BANDGAP_MIN_MV) {
+    bandgap = BANDGAP_MIN_MV;
+  } else if (bandgap > BANDGAP_MAX_MV) {
+    bandgap = BANDGAP_MAX_MV;
+  }
+  failReading = READING(bandgap, POWER_FAIL_MV);
+  okReading = READING(bandgap, POWER_OK_MV);
+
+  // compare B comes once per 1ms tick of the wheel
+  OCR0B = 0;
+  TIMSK0 |= (1 << OCIE0B);
+  timerArm(&reportTimer, POWER_REPORT, POWER_REPORT, report);
+}
+
+uint8_t powerLow() { return saved; }
+
+uint8_t powerRestore(Vars *vars, Zones *zones, State *state) {
+  Checkpoint data;
+
+  eeprom_read_block((void *)&data, (const void *)EEPROM_CHECKPOINT,
+                    sizeof(data));
+  if (data.crc != checkpointCrc(&data)) {
+    return 0;
+  }
+
+  for (uint8_t i = 0; i < sizeof(vars->time); i++) {
+    vars->time[i] = data.time[i];
+  }
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    zones->speed[z] = data.speed[z];
+    zones->motorOn[z] = data.speed[z] != 0;
+  }
+  *state = data.state;
+
+  // it's only good for this boot, next time the clock comes from the next
+  // checkpoint or EEPROM_TIME
+  invalidate();
+  return 1;
+}
+
+// measure the supply every POWER_POLL ms, checkpoint once it's failing and
+// invalidate the checkpoint if it comes back. the main loop can be stuck in
+// a delay or a blocking write for longer than the hold-up time, so this
+// doesn't wait for it
+ISR(TIMER0_COMPB_vect) {
+  if (++pollMs < POWER_POLL) {
+    return;
+  }
+  pollMs = 0;
+
+  uint16_t reading = adcReadIsr(ADC_BANDGAP);
+  if (reading < okReading) {
+    lowCount = 0;
+    if (!saved) {
+      return;
+    }
+  } else if (reading <= failReading || saved || ++lowCount < POWER_SAMPLES) {
+    return;
+  }
+
+  // the main loop may be half way through an EEPROM access, its address and
+  // data are put back once the write here is done
+  uint16_t eear = EEAR;
+  uint8_t eedr = EEDR;
+  if (saved) {
+    // the supply came back, the checkpoint would be stale by the next cold
+    // boot
+    invalidate();
+  } else {
+    checkpoint();
+  }
+  eeprom_busy_wait();
+  EEAR = eear;
+  EEDR = eedr;
+  saved = !saved;
+  lastReading = reading;
+}
+
+static void report() {
+  uint8_t now;
+  uint16_t reading;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    now = saved;
+    reading = lastReading;
+  }
+  if (now != reported) {
+    if (now) {
+      LOG_WARN("supply low, bandgap reading %u", reading);
+    } else {
+      LOG_WARN("supply back, bandgap reading %u", reading);
+    }
+    reported = now;
+  }
+}
+
+static void checkpoint() {
+  Checkpoint data;
+
+  for (uint8_t i = 0; i < sizeof(data.time); i++) {
+    data.time[i] = vars.time[i];
+  }
+  data.state = currentState;
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    data.speed[z] = zones.speed[z];
+    // the fans are the biggest load on the hold-up capacitor, motorControl()
+    // keeps them off until the supply is back (powerLow())
+    pwmSetDuty(zoneFan[z], 0);
+  }
+  data.crc = checkpointCrc(&data);
+
+  // only the bytes that changed are written
+  eeprom_update_block((const void *)&data, (void *)EEPROM_CHECKPOINT,
+                      sizeof(data));
+}
+
+static void invalidate() {
+  uint8_t *crc = (uint8_t *)(EEPROM_CHECKPOINT + offsetof(Checkpoint, crc));
+  eeprom_update_byte(crc, ~eeprom_read_byte(crc));
+}
+
+static uint16_t checkpointCrc(const Checkpoint *data) {
+  const uint8_t *p = (const uint8_t *)data;
+  const uint8_t *end = p + offsetof(Checkpoint, crc);
+  uint16_t crc = 0xFFFF;
+  while (p < end) {
+    crc = _crc16_update(crc, *p++);
+  }
+  return crc;
+}
@@ -0,0 +1,269 @@
+#include "../include/proto.h"
+#include "../include/event.h"
+#include "../include/fan.h"
+#include "../include/main.h"
+#include "../include/rtc.h"
+#include "../include/uart.h"
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <inttypes.h>
+#include <util/atomic.h>
+#include <util/crc16.h>
+
+extern Vars vars;
+extern Zones zones;
+extern State currentState;
+
+_Static_assert(REG_COUNT <= 256, "too many zones for the register map");
+
+// register access flags
+#define READ 0x01
+#define WRITE 0x02
+#define NO_EEPROM 0xFF
+
+typedef struct {
+  uint8_t *ram;   // backing variable
+  uint8_t eeprom; // EEPROM address or NO_EEPROM
+  uint8_t flags;  // READ/WRITE
+  uint8_t min;    // valid range for writes
+  uint8_t max;
+} RegisterDef;
+
+static const RegisterDef registers[REG_ZONES] PROGMEM = {
+    [REG_TEMP] = {&zones.currentTemp[0], NO_EEPROM, READ, 0, 0},
+    [REG_MOTOR_ON] = {&zones.motorOn[0], NO_EEPROM, READ, 0, 0},
+    [REG_SPEED] = {&zones.speed[0], NO_EEPROM, READ, 0, 0},
+    [REG_STATE] = {(uint8_t *)&currentState, NO_EEPROM, READ, 0, 0},
+    [REG_MAX_SPEED] = {&zones.maxSpeed[0], EEPROM_MAX_SPEED, READ | WRITE,
+                       MIN_SPEED, MAX_SPEED},
+    [REG_THRESHOLD] = {&zones.tempThreshold[0], EEPROM_THRESHOLD,
+                       READ | WRITE, MIN_TEMP, MAX_TEMP},
+    [REG_TIME_H] = {&vars.time[0], EEPROM_TIME + 0, READ | WRITE, 0, 23},
+    [REG_TIME_M] = {&vars.time[1], EEPROM_TIME + 1, READ | WRITE, 0, 59},
+    [REG_TIME_S] = {&vars.time[2], EEPROM_TIME + 2, READ | WRITE, 0, 59},
+    [REG_ALARM_H] = {&vars.alarm[0], EEPROM_ALARM + 0, READ | WRITE, 0, 23},
+    [REG_ALARM_M] = {&vars.alarm[1], EEPROM_ALARM + 1, READ | WRITE, 0, 59},
+    [REG_ALARM_S] = {&vars.alarm[2], EEPROM_ALARM + 2, READ | WRITE, 0, 59},
+    [REG_PASSWORD_0] = {(uint8_t *)&vars.password[0], EEPROM_PASSWORD + 0,
+                        WRITE, '1', '2'},
+    [REG_PASSWORD_1] = {(uint8_t *)&vars.password[1], EEPROM_PASSWORD + 1,
+                        WRITE, '1', '2'},
+    [REG_PASSWORD_2] = {(uint8_t *)&vars.password[2], EEPROM_PASSWORD + 2,
+                        WRITE, '1', '2'},
+    [REG_PASSWORD_3] = {(uint8_t *)&vars.password[3], EEPROM_PASSWORD + 3,
+                        WRITE, '1', '2'},
+    [REG_EVENTS_DROPPED] = {(uint8_t *)&eventDroppedTotal, NO_EEPROM, READ, 0,
+                            0},
+};
+
+// registers of the other zones, relative to the first zone
+static const RegisterDef zoneRegisters[ZONE_REGS] PROGMEM = {
+    [ZONE_REG_TEMP] = {&zones.currentTemp[0], NO_EEPROM, READ, 0, 0},
+    [ZONE_REG_MOTOR_ON] = {&zones.motorOn[0], NO_EEPROM, READ, 0, 0},
+    [ZONE_REG_SPEED] = {&zones.speed[0], NO_EEPROM, READ, 0, 0},
+    [ZONE_REG_MAX_SPEED] = {&zones.maxSpeed[0], NO_EEPROM, READ | WRITE,
+                            MIN_SPEED, MAX_SPEED},
+    [ZONE_REG_THRESHOLD] = {&zones.tempThreshold[0], NO_EEPROM, READ | WRITE,
+                            MIN_TEMP, MAX_TEMP},
+};
+
+// copy a register definition out of flash, returns 0 if it doesn't exist
+static uint8_t lookup(uint8_t id, RegisterDef *reg) {
+  if (id < REG_ZONES) {
+    memcpy_P(reg, &registers[id], sizeof(*reg));
+    return 1;
+  }
+
+  uint8_t zone = (id - REG_ZONES) / ZONE_REGS + 1;
+  uint8_t field = (id - REG_ZONES) % ZONE_REGS;
+  if (zone >= ZONE_COUNT) {
+    return 0;
+  }
+  memcpy_P(reg, &zoneRegisters[field], sizeof(*reg));
+  reg->ram += zone;
+  if (field == ZONE_REG_MAX_SPEED) {
+    reg->eeprom = EEPROM_ZONE_MAX_SPEED(zone);
+  } else if (field == ZONE_REG_THRESHOLD) {
+    reg->eeprom = EEPROM_ZONE_THRESHOLD(zone);
+  }
+  return 1;
+}
+
+// parser states
+typedef enum { WAIT_SOF, WAIT_LEN, WAIT_CMD, PAYLOAD, CRC_LO, CRC_HI } Parser;
+
+static Parser parser = WAIT_SOF;
+static uint8_t length;
+static uint8_t count;
+static uint16_t crc;
+static uint8_t command;
+static uint8_t payload[PROTO_MAX_PAYLOAD];
+// 0: idle, 1: valid request pending, 2: CRC error pending
+static volatile uint8_t pending = 0;
+
+void protoReceive(uint8_t byte) {
+  // the previous request hasn't been handled yet, drop the byte
+  if (pending) {
+    return;
+  }
+
+  switch (parser) {
+  case WAIT_SOF:
+    if (byte == PROTO_SOF) {
+      crc = 0xFFFF;
+      parser = WAIT_LEN;
+    }
+    break;
+
+  case WAIT_LEN:
+    if (byte > PROTO_MAX_PAYLOAD) {
+      parser = WAIT_SOF;
+      break;
+    }
+    length = byte;
+    count = 0;
+    crc = _crc_ccitt_update(crc, byte);
+    parser = WAIT_CMD;
+    break;
+
+  case WAIT_CMD:
+    command = byte;
+    crc = _crc_ccitt_update(crc, byte);
+    parser = length ? PAYLOAD : CRC_LO;
+    break;
+
+  case PAYLOAD:
+    payload[count++] = byte;
+    crc = _crc_ccitt_update(crc, byte);
+    if (count == length) {
+      parser = CRC_LO;
+    }
+    break;
+
+  case CRC_LO:
+    crc ^= byte;
+    parser = CRC_HI;
+    break;
+
+  case CRC_HI:
+    crc ^= (uint16_t)byte << 8;
+    pending = crc ? 2 : 1;
+    parser = WAIT_SOF;
+    break;
+  }
+}
+
+void protoSend(uint8_t cmd, const uint8_t *data, uint8_t len) {
+  uint8_t frame[PROTO_MAX_PAYLOAD + 5];
+  uint16_t sum = 0xFFFF;
+
+  frame[0] = PROTO_SOF;
+  frame[1] = len;
+  frame[2] = cmd;
+  for (uint8_t i = 0; i < len; i++) {
+    frame[3 + i] = data[i];
+  }
+  for (uint8_t i = 1; i < len + 3; i++) {
+    sum = _crc_ccitt_update(sum, frame[i]);
+  }
+  frame[len + 3] = sum & 0xFF;
+  frame[len + 4] = sum >> 8;
+
+  // in one go, see uartWrite()
+  uartWrite(frame, len + 5);
+}
+
+static void sendError(uint8_t code, uint8_t index) {
+  uint8_t data[2] = {code, index};
+  protoSend(PROTO_ERROR, data, sizeof(data));
+}
+
+static void handleRead() {
+  RegisterDef reg;
+
+  for (uint8_t i = 0; i < length; i++) {
+    if (!lookup(payload[i], &reg)) {
+      sendError(PROTO_ERR_REG, i);
+      return;
+    }
+    if (!(reg.flags & READ)) {
+      sendError(PROTO_ERR_ACCESS, i);
+      return;
+    }
+    // replace the register number with its value
+    payload[i] = *reg.ram;
+  }
+  protoSend(PROTO_READ | PROTO_REPLY, payload, length);
+}
+
+static void handleWrite() {
+  RegisterDef reg;
+
+  if (length & 1) {
+    sendError(PROTO_ERR_LENGTH, length);
+    return;
+  }
+
+  // validate the whole batch first
+  for (uint8_t i = 0; i < length; i += 2) {
+    if (!lookup(payload[i], &reg)) {
+      sendError(PROTO_ERR_REG, i);
+      return;
+    }
+    if (!(reg.flags & WRITE)) {
+      sendError(PROTO_ERR_ACCESS, i);
+      return;
+    }
+    if (payload[i + 1] < reg.min || payload[i + 1] > reg.max) {
+      sendError(PROTO_ERR_VALUE, i + 1);
+      return;
+    }
+  }
+
+  // then apply it (the clock is also updated by the timer ISR)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    for (uint8_t i = 0; i < length; i += 2) {
+      lookup(payload[i], &reg);
+      *reg.ram = payload[i + 1];
+    }
+  }
+  uint8_t maxSpeed = 0; // a max speed changed, the fan table is stale
+  for (uint8_t i = 0; i < length; i += 2) {
+    lookup(payload[i], &reg);
+    eeprom_update_byte((uint8_t *)(uint16_t)reg.eeprom, payload[i + 1]);
+    maxSpeed |= reg.ram >= zones.maxSpeed &&
+                reg.ram < zones.maxSpeed + ZONE_COUNT;
+  }
+  if (maxSpeed) {
+    fanCompile();
+  }
+#ifdef RTC_DS1307
+  // keep the RTC in step with clock writes
+  for (uint8_t i = 0; i < length; i += 2) {
+    if (payload[i] >= REG_TIME_H && payload[i] <= REG_TIME_S) {
+      rtcWrite(vars.time);
+      break;
+    }
+  }
+#endif
+  protoSend(PROTO_WRITE | PROTO_REPLY, 0, 0);
+}
+
+void protoPoll() {
+  if (!pending) {
+    return;
+  }
+
+  if (pending == 2) {
+    sendError(PROTO_ERR_CRC, 0);
+  } else if (command == PROTO_READ) {
+    handleRead();
+  } else if (command == PROTO_WRITE) {
+    handleWrite();
+  } else {
+    sendError(PROTO_ERR_CMD, 0);
+  }
+
+  // ready for the next request
+  pending = 0;
+}
@@ -0,0 +1,51 @@
+#include "../include/rtc.h"
+#include "../include/twi.h"
+#include <inttypes.h>
+
+// registers 0x00-0x02: seconds, minutes, hours (BCD, 24h mode)
+static const uint8_t rtcRegister = 0x00;
+static uint8_t rtcBuffer[4]; // register address + 3 bytes
+static uint8_t *rtcTarget;   // where rtcRead() puts the time
+
+static uint8_t fromBcd(uint8_t bcd) { return (bcd >> 4) * 10 + (bcd & 0x0F); }
+
+static uint8_t toBcd(uint8_t value) { return ((value / 10) << 4) | value % 10; }
+
+// runs in the TWI ISR
+static void readDone(uint8_t status) {
+  if (status != TWI_OK) {
+    return;
+  }
+  rtcTarget[0] = fromBcd(rtcBuffer[2] & 0x3F); // hours, 24h mode
+  rtcTarget[1] = fromBcd(rtcBuffer[1] & 0x7F);
+  rtcTarget[2] = fromBcd(rtcBuffer[0] & 0x7F); // bit 7: clock halt
+}
+
+void rtcRead(uint8_t *time) {
+  TwiTransaction t = {
+      .address = RTC_ADDR,
+      .txData = &rtcRegister,
+      .txLength = 1,
+      .rxData = rtcBuffer,
+      .rxLength = 3,
+      .done = readDone,
+  };
+  // don't touch the buffer while a transaction still uses it
+  twiFlush();
+  rtcTarget = time;
+  twiSubmit(&t);
+}
+
+void rtcWrite(const uint8_t *time) {
+  TwiTransaction t = {
+      .address = RTC_ADDR,
+      .txData = rtcBuffer,
+      .txLength = 4,
+  };
+  twiFlush();
+  rtcBuffer[0] = rtcRegister;
+  rtcBuffer[1] = toBcd(time[2]); // clock halt bit cleared
+  rtcBuffer[2] = toBcd(time[1]);
+  rtcBuffer[3] = toBcd(time[0]); // 24h mode
+  twiSubmit(&t);
+}
@@ -0,0 +1,9 @@
+#include "../include/scratch.h"
+#include <string.h>
+
+// a screen whose state doesn't fit has to keep it smaller, not grow .bss
+_Static_assert(sizeof(Scratch) <= SCRATCH_BUDGET, "screen scratch too large");
+
+Scratch scratch;
+
+void scratchReset() { memset(&scratch, 0, sizeof(scratch)); }
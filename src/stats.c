@@ -0,0 +1,149 @@
+#include "../include/stats.h"
+#include <inttypes.h>
+
+// Sliding windows of STATS_SLOTS slots. Every slot holds the min/avg/max of
+// one sample (minute window) or of a bucket of samples from the window
+// below it (hour and day windows). Each window keeps a running sum for the
+// average and two monotonic queues of slot indices for the min and max, so
+// adding a slot is O(1) (amortized) and a query never scans the window.
+
+typedef struct {
+  uint8_t avg[STATS_SLOTS];
+  uint8_t min[STATS_SLOTS];
+  uint8_t max[STATS_SLOTS];
+  uint8_t minQueue[STATS_SLOTS]; // slots with increasing min, oldest first
+  uint8_t maxQueue[STATS_SLOTS]; // slots with decreasing max, oldest first
+  uint16_t sum;                  // sum of avg[] over the filled slots
+  uint8_t head;                  // next slot to write
+  uint8_t count;                 // no. of filled slots
+  uint8_t minFront, minCount;
+  uint8_t maxFront, maxCount;
+} Window;
+
+// summary of the slots collected for the next slot of the window above
+typedef struct {
+  uint16_t sum;
+  uint8_t min;
+  uint8_t max;
+  uint8_t count;
+} Bucket;
+
+typedef struct {
+  Window windows[STATS_WINDOWS];
+  Bucket hourBucket;
+  Bucket dayBucket;
+} Series;
+
+static Series series[STATS_SERIES];
+static uint8_t sampleTimer = 0;
+
+// ring index arithmetic for i < 2 * STATS_SLOTS
+static uint8_t wrap(uint8_t i) {
+  return (i >= STATS_SLOTS) ? i - STATS_SLOTS : i;
+}
+
+static void windowPush(Window *w, uint8_t avg, uint8_t min, uint8_t max) {
+  uint8_t slot = w->head;
+
+  if (w->count == STATS_SLOTS) {
+    // the oldest slot drops out of the window
+    w->sum -= w->avg[slot];
+    if (w->minCount && w->minQueue[w->minFront] == slot) {
+      w->minFront = wrap(w->minFront + 1);
+      w->minCount--;
+    }
+    if (w->maxCount && w->maxQueue[w->maxFront] == slot) {
+      w->maxFront = wrap(w->maxFront + 1);
+      w->maxCount--;
+    }
+  } else {
+    w->count++;
+  }
+
+  w->avg[slot] = avg;
+  w->min[slot] = min;
+  w->max[slot] = max;
+  w->sum += avg;
+
+  // older slots that can't be the min/max anymore leave the queues
+  while (w->minCount &&
+         w->min[w->minQueue[wrap(w->minFront + w->minCount - 1)]] >= min) {
+    w->minCount--;
+  }
+  w->minQueue[wrap(w->minFront + w->minCount)] = slot;
+  w->minCount++;
+
+  while (w->maxCount &&
+         w->max[w->maxQueue[wrap(w->maxFront + w->maxCount - 1)]] <= max) {
+    w->maxCount--;
+  }
+  w->maxQueue[wrap(w->maxFront + w->maxCount)] = slot;
+  w->maxCount++;
+
+  w->head = wrap(slot + 1);
+}
+
+// add a slot to a bucket, returns 1 and the bucket summary once it is full
+static uint8_t bucketAdd(Bucket *b, uint8_t avg, uint8_t min, uint8_t max,
+                         uint8_t size, Summary *out) {
+  if (b->count == 0) {
+    b->sum = 0;
+    b->min = min;
+    b->max = max;
+  } else {
+    if (min < b->min) {
+      b->min = min;
+    }
+    if (max > b->max) {
+      b->max = max;
+    }
+  }
+  b->sum += avg;
+  b->count++;
+
+  if (b->count < size) {
+    return 0;
+  }
+  out->min = b->min;
+  out->avg = b->sum / b->count;
+  out->max = b->max;
+  b->count = 0;
+  return 1;
+}
+
+static void seriesAdd(Series *s, uint8_t value) {
+  Summary hour, day;
+
+  windowPush(&s->windows[STATS_MINUTE], value, value, value);
+  if (bucketAdd(&s->hourBucket, value, value, value, STATS_HOUR_BUCKET,
+                &hour)) {
+    windowPush(&s->windows[STATS_HOUR], hour.avg, hour.min, hour.max);
+    if (bucketAdd(&s->dayBucket, hour.avg, hour.min, hour.max,
+                  STATS_DAY_BUCKET, &day)) {
+      windowPush(&s->windows[STATS_DAY], day.avg, day.min, day.max);
+    }
+  }
+}
+
+void statsSample(uint8_t temp, uint8_t duty) {
+  sampleTimer++;
+  if (sampleTimer < STATS_SAMPLE_TIME) {
+    return;
+  }
+  sampleTimer = 0;
+
+  seriesAdd(&series[STATS_TEMP], temp);
+  seriesAdd(&series[STATS_DUTY], duty);
+}
+
+uint8_t statsGet(StatsSeries s, StatsWindow window, Summary *out) {
+  // statsSample() runs in the main context (secondTick()), no locking
+  const Window *w = &series[s].windows[window];
+  if (!w->count) {
+    return 0;
+  }
+  out->min = w->min[w->minQueue[w->minFront]];
+  out->avg = w->sum / w->count;
+  out->max = w->max[w->maxQueue[w->maxFront]];
+  return 1;
+}
@@ -0,0 +1,88 @@
+#include "../include/trace.h"
+#include "../include/main.h"
+#include "../include/power.h"
+#include "../include/proto.h"
+#include "../include/wheel.h"
+#include <avr/eeprom.h>
+#include <inttypes.h>
+
+_Static_assert(EEPROM_CHECKPOINT + sizeof(Checkpoint) <= TRACE_EEPROM_SIZE,
+               "the trace misses settings");
+
+static uint8_t settings[TRACE_EEPROM_SIZE]; // EEPROM at boot
+static uint8_t frame[PROTO_MAX_PAYLOAD / TRACE_RECORD_SIZE *
+                     TRACE_RECORD_SIZE];
+static uint8_t length = 0;               // of the frame
+static uint16_t last;                    // time of the last record
+static uint16_t samples[TRACE_CHANNELS]; // last value recorded per channel
+static Timer flushTimer;
+
+// add a record, dt is filled in
+static void record(uint8_t kind, uint8_t a, uint8_t b);
+
+// add a record as it is, sending the frame when it's full
+static void put(uint8_t b0, uint8_t b1, uint8_t b2);
+
+// send what's been recorded (flushTimer callback)
+static void sendRecords();
+
+void traceInit() {
+  eeprom_read_block(settings, (const void *)0, sizeof(settings));
+  for (uint8_t i = 0; i < TRACE_CHANNELS; i++) {
+    samples[i] = UINT16_MAX;
+  }
+}
+
+void traceStart() {
+  for (uint8_t i = 0; i < TRACE_EEPROM_SIZE; i++) {
+    put(TRACE_EEPROM, i, settings[i]);
+  }
+  last = wheelNow();
+  timerArm(&flushTimer, TRACE_FLUSH, TRACE_FLUSH, sendRecords);
+}
+
+void traceAdc(uint8_t channel, uint16_t value) {
+  channel &= TRACE_CHANNELS - 1;
+  if (samples[channel] == value) {
+    return;
+  }
+  samples[channel] = value;
+  record(TRACE_ADC | channel, value & 0xFF, (value >> 8) << 6);
+}
+
+void traceKey() { record(TRACE_KEY, 0, 0); }
+
+static void record(uint8_t kind, uint8_t a, uint8_t b) {
+  uint16_t now = wheelNow();
+  uint16_t dt = now - last;
+
+  last = now;
+  if (dt > TRACE_DT_MAX) {
+    put(TRACE_DELAY, dt & 0xFF, dt >> 8);
+    dt = 0;
+  }
+  put(kind, a, b | dt);
+}
+
+static void put(uint8_t b0, uint8_t b1, uint8_t b2) {
+  frame[length++] = b0;
+  frame[length++] = b1;
+  frame[length++] = b2;
+  if (length == sizeof(frame)) {
+    sendRecords();
+  }
+}
+
+static void sendRecords() {
+  // keep dt from overflowing while nothing changes
+  uint16_t idle = wheelNow() - last;
+  if (idle > TRACE_IDLE) {
+    last += idle;
+    put(TRACE_DELAY, idle & 0xFF, idle >> 8);
+  }
+
+  if (length) {
+    protoSend(PROTO_TRACE, frame, length);
+    length = 0;
+  }
+}
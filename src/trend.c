@@ -0,0 +1,102 @@
+#include "../include/trend.h"
+#include "../include/fan.h"
+#include "../include/log.h"
+#include "../include/pattern.h"
+#include <inttypes.h>
+
+// x is the position in the window, 0 for the oldest sample
+#define SUM_X (TREND_WINDOW * (TREND_WINDOW - 1) / 2)
+// N * sum(x^2) - sum(x)^2, the denominator of the slope
+#define DENOMINATOR                                                            \
+  ((int32_t)TREND_WINDOW * TREND_WINDOW *                                      \
+   (TREND_WINDOW * TREND_WINDOW - 1) / 12)
+
+_Static_assert((uint32_t)SUM_X * MAX_TEMP <= UINT16_MAX,
+               "TREND_WINDOW too long for the 16-bit sums");
+_Static_assert((TREND_WINDOW & (TREND_WINDOW - 1)) == 0,
+               "TREND_WINDOW must be a power of 2");
+_Static_assert(ZONE_COUNT <= 8, "one warning bit per zone");
+
+typedef struct {
+  uint8_t samples[ZONE_COUNT][TREND_WINDOW];
+  uint16_t sumY[ZONE_COUNT];  // sum(y)
+  uint16_t sumXY[ZONE_COUNT]; // sum(x * y)
+  int16_t slope[ZONE_COUNT];  // 1/256 C per sample
+  uint8_t head;               // oldest sample, replaced by the next one
+  uint8_t filled;             // the window holds samples
+  uint8_t steps;              // control steps since the last sample
+  uint8_t warned;             // bit per zone projected over OVER_TEMP
+} Trend;
+
+static Trend trend;
+
+// warn once when a zone is projected to reach OVER_TEMP, the LED flashes
+// until no zone is
+static void warn(uint8_t zone, uint8_t temp);
+
+void trendSample(const uint8_t *temps) {
+  if (trend.filled && ++trend.steps < TREND_PERIOD) {
+    return;
+  }
+  trend.steps = 0;
+
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    uint8_t y = temps[z];
+
+    if (!trend.filled) {
+      // start flat at the first reading
+      for (uint8_t i = 0; i < TREND_WINDOW; i++) {
+        trend.samples[z][i] = y;
+      }
+      trend.sumY[z] = TREND_WINDOW * y;
+      trend.sumXY[z] = SUM_X * y;
+    } else {
+      // every sample moves one position down, the oldest one leaves at 0
+      // and the new one comes in at TREND_WINDOW - 1
+      uint8_t old = trend.samples[z][trend.head];
+      trend.sumXY[z] -= trend.sumY[z] - old;
+      trend.sumXY[z] += (TREND_WINDOW - 1) * y;
+      trend.sumY[z] += y - old;
+      trend.samples[z][trend.head] = y;
+    }
+
+    int32_t num =
+        (int32_t)TREND_WINDOW * trend.sumXY[z] - (int32_t)SUM_X * trend.sumY[z];
+    trend.slope[z] = num * 256 / DENOMINATOR;
+    warn(z, y);
+  }
+
+  trend.filled = 1;
+  trend.head = (trend.head + 1) & (TREND_WINDOW - 1);
+}
+
+uint8_t trendRise(uint8_t zone, uint16_t samples) {
+  if (trend.slope[zone] <= 0) {
+    return 0;
+  }
+  uint32_t rise = ((uint32_t)trend.slope[zone] * samples + 128) >> 8;
+  return rise > MAX_TEMP ? MAX_TEMP : rise;
+}
+
+int16_t trendSlope(uint8_t zone) { return trend.slope[zone]; }
+
+static void warn(uint8_t zone, uint8_t temp) {
+  uint8_t projected = temp + trendRise(zone, TREND_WARN_SAMPLES);
+  uint8_t bit = 1 << zone;
+
+  if (projected >= OVER_TEMP && temp < OVER_TEMP) {
+    if (!(trend.warned & bit)) {
+      LOG_WARN("zone %u over temperature in %u min", zone + 1,
+               TREND_WARN_AHEAD);
+      trend.warned |= bit;
+    }
+  } else if (projected + FAN_HYSTERESIS < OVER_TEMP) {
+    trend.warned &= ~bit;
+  }
+
+  if (trend.warned) {
+    patternPlay(PATTERN_TREND);
+  } else {
+    patternStop(PATTERN_TREND);
+  }
+}
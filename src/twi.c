@@ -0,0 +1,123 @@
+#include "../include/twi.h"
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <inttypes.h>
+#include <util/atomic.h>
+
+// status codes (TWSR & 0xF8)
+#define START 0x08
+#define REP_START 0x10
+#define MT_SLA_ACK 0x18
+#define MT_DATA_ACK 0x28
+#define MR_SLA_ACK 0x40
+#define MR_DATA_ACK 0x50
+#define MR_DATA_NACK 0x58
+
+// TWCR values
+#define TWCR_NEXT ((1 << TWINT) | (1 << TWEN) | (1 << TWIE))
+#define TWCR_START (TWCR_NEXT | (1 << TWSTA))
+#define TWCR_STOP ((1 << TWINT) | (1 << TWEN) | (1 << TWSTO))
+
+static TwiTransaction queue[TWI_QUEUE_SIZE];
+static volatile uint8_t head = 0;  // next free slot
+static volatile uint8_t tail = 0;  // transaction in progress
+static volatile uint8_t count = 0; // no. of queued transactions
+static uint8_t index;              // byte index within the current phase
+static uint8_t reading;            // current phase is the read phase
+
+// the current transaction is done, stop (and start the next one)
+static void finish(uint8_t status) {
+  TwiTransaction *t = &queue[tail];
+
+  tail = (tail + 1) & (TWI_QUEUE_SIZE - 1);
+  count--;
+  // STOP followed by START if there's more to do
+  TWCR = count ? (TWCR_STOP | TWCR_START) : TWCR_STOP;
+  index = 0;
+  reading = 0;
+
+  if (t->done) {
+    t->done(status);
+  }
+}
+
+ISR(TWI_vect) {
+  TwiTransaction *t = &queue[tail];
+
+  switch (TWSR & 0xF8) {
+  case START:
+  case REP_START:
+    // write phase first, if there is one
+    reading = (reading || t->txLength == 0);
+    index = 0;
+    TWDR = (t->address << 1) | reading;
+    TWCR = TWCR_NEXT;
+    break;
+
+  case MT_SLA_ACK:
+  case MT_DATA_ACK:
+    if (index < t->txLength) {
+      TWDR = t->txData[index++];
+      TWCR = TWCR_NEXT;
+    } else if (t->rxLength) {
+      // switch to reading with a repeated start
+      reading = 1;
+      TWCR = TWCR_START;
+    } else {
+      finish(TWI_OK);
+    }
+    break;
+
+  case MR_SLA_ACK:
+    // ACK every byte but the last one
+    TWCR = (t->rxLength > 1) ? (TWCR_NEXT | (1 << TWEA)) : TWCR_NEXT;
+    break;
+
+  case MR_DATA_ACK:
+    t->rxData[index++] = TWDR;
+    TWCR = (index < t->rxLength - 1) ? (TWCR_NEXT | (1 << TWEA)) : TWCR_NEXT;
+    break;
+
+  case MR_DATA_NACK:
+    t->rxData[index] = TWDR;
+    finish(TWI_OK);
+    break;
+
+  default:
+    // NACK or lost arbitration
+    finish(TWI_ERROR);
+    break;
+  }
+}
+
+void twiInit() {
+  // SCL = F_CPU / (16 + 2 * TWBR * prescaler), prescaler 1
+  TWSR = 0;
+  TWBR = ((F_CPU / TWI_FREQ) - 16) / 2;
+  TWCR = (1 << TWEN);
+}
+
+uint8_t twiSubmit(const TwiTransaction *t) {
+  uint8_t queued = 0;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (count < TWI_QUEUE_SIZE) {
+      queue[head] = *t;
+      head = (head + 1) & (TWI_QUEUE_SIZE - 1);
+      count++;
+      // the bus is idle, start right away
+      if (count == 1) {
+        TWCR = TWCR_START;
+      }
+      queued = 1;
+    }
+  }
+  return queued;
+}
+
+uint8_t twiBusy() { return count != 0; }
+
+void twiFlush() {
+  while (count)
+    ;
+}
@@ -0,0 +1,66 @@
+#include "../include/uart.h"
+#include "../include/log.h"
+#include "../include/proto.h"
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <inttypes.h>
+#include <util/setbaud.h>
+
+_Static_assert(UART_TX_SIZE <= 256 && (UART_TX_SIZE & (UART_TX_SIZE - 1)) == 0,
+               "UART_TX_SIZE must be a power of 2 up to 256");
+
+static uint8_t txBuffer[UART_TX_SIZE];
+static volatile uint8_t txHead = 0;    // written by uartWrite()
+static volatile uint8_t txTail = 0;    // written by the UDRE ISR
+static volatile uint8_t txWriting = 0; // uartWrite() is queuing a frame
+
+// received bytes go straight into the protocol parser
+ISR(BOARD_UART_RX_VECT) { protoReceive(UDR0); }
+
+// send the next queued byte, stop when the buffer is empty. log frames go
+// out in between, but never in the middle of another frame
+ISR(BOARD_UART_UDRE_VECT) {
+  int16_t byte = logNext(txHead == txTail && !txWriting);
+
+  if (byte >= 0) {
+    UDR0 = byte;
+  } else if (txHead != txTail) {
+    UDR0 = txBuffer[txTail];
+    txTail = (txTail + 1) & (UART_TX_SIZE - 1);
+  } else {
+    UCSR0B &= ~(1 << UDRIE0);
+  }
+}
+
+void uartInit() {
+  UBRR0H = UBRRH_VALUE;
+  UBRR0L = UBRRL_VALUE;
+#if USE_2X
+  UCSR0A |= (1 << U2X0);
+#else
+  UCSR0A &= ~(1 << U2X0);
+#endif
+  // 8 data bits, no parity, 1 stop bit
+  UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);
+  UCSR0B = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
+}
+
+void uartWrite(const uint8_t *data, uint8_t len) {
+  txWriting = 1;
+  while (len--) {
+    uint8_t next = (txHead + 1) & (UART_TX_SIZE - 1);
+    // wait for the ISR to make room
+    while (next == txTail)
+      ;
+    txBuffer[txHead] = *data++;
+    txHead = next;
+    UCSR0B |= (1 << UDRIE0);
+  }
+  txWriting = 0;
+  // the ISR may have stopped while a log frame was held back
+  uartKick();
+}
+
+uint8_t uartFree() { return (txTail - txHead - 1) & (UART_TX_SIZE - 1); }
+
+void uartKick() { UCSR0B |= (1 << UDRIE0); }
@@ -1,5 +1,6 @@
 #include "include/util.h"
 #include "include/adc.h"
+#include "include/board.h"
 #include <avr/io.h>
 #include <inttypes.h>
 #include <string.h>
@@ -29,7 +30,7 @@ void removeCursor(char *str) {
 }
 
 Input getKeypad() {
-  uint16_t adc = adcRead(0);
+  uint16_t adc = adcRead(BOARD_KEYPAD_ADC);
   if (adc > 510) {
     return NOINPUT;
   } else if (adc > 450 && adc < 510) {
@@ -45,10 +46,15 @@ Input getKeypad() {
   }
 }
 
+#define PWM_OUTPUT(channel, ocr, ddr, bit) ddr |= (1 << bit);
+#define PWM_CASE(channel, ocr, ddr, bit)                                       \
+  case channel:                                                                \
+    ocr = duty_cycle;                                                          \
+    break;
+
 void pmwInit() {
-  // Set OC2A (PB3) and OC2B (PD3) as output pins
-  DDRB |= (1 << DDB3); // OC2A output
-  DDRD |= (1 << DDD3); // OC2B output
+  // Set the compare outputs of the board's channels as output pins
+  BOARD_PWM_TABLE(PWM_OUTPUT)
 
   // Configure Timer2 for Fast PWM mode
   TCCR2A = (1 << COM2A1) | (1 << COM2B1) | (1 << WGM21) | (1 << WGM20);
@@ -60,14 +66,17 @@ void pmwInit() {
   OCR2A = 0; // Channel A duty cycle (0-255)
   OCR2B = 0; // Channel B duty cycle (0-255)
              // PWM frequency = 16MHz / (64 * 256) = ~976 Hz
+
+#ifdef BOARD_PWM_TIMER4
+  // Timer4 in 8-bit Fast PWM mode with the same prescaler and frequency
+  TCCR4A = (1 << COM4A1) | (1 << COM4B1) | (1 << COM4C1) | (1 << WGM40);
+  TCCR4B = (1 << WGM42) | (1 << CS41) | (1 << CS40);
+  OCR4A = 0;
+  OCR4B = 0;
+  OCR4C = 0;
+#endif
 }
 
 void pwmSetDuty(uint8_t channel, uint8_t duty_cycle) {
-  if (channel == 0) {
-    // Channel A (PB3)
-    OCR2A = duty_cycle;
-  } else if (channel == 1) {
-    // Channel B (PD3)
-    OCR2B = duty_cycle;
-  }
+  switch (channel) { BOARD_PWM_TABLE(PWM_CASE) }
 }
\ No newline at end of file
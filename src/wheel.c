@@ -0,0 +1,120 @@
+#include "../include/wheel.h"
+#include "../include/board.h"
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <util/atomic.h>
+
+// Timer0 compare value for a 1ms tick with the prescaler at 64
+#define TICK_RELOAD (F_CPU / 64 / 1000 - 1)
+_Static_assert(TICK_RELOAD <= 0xFF, "F_CPU too fast for the 1ms tick");
+_Static_assert(F_CPU % (64UL * 1000) == 0, "F_CPU can't make a 1ms tick");
+
+static Timer *slots[WHEEL_SLOTS];
+static Timer *expired; // timers whose callbacks are about to run
+static uint8_t current = 0; // slot of the last tick handled
+static uint16_t handled = 0; // ticks handled by wheelRun()
+static volatile uint16_t ticks = 0;
+
+// put a timer on a slot
+static void addTimer(Timer *timer, uint16_t ms);
+
+// take a timer off its list
+static void removeTimer(Timer *timer);
+
+ISR(TIMER0_COMPA_vect) { ticks++; }
+
+void wheelInit() {
+  TCCR0A = (1 << WGM01);              // CTC
+  TCCR0B = (1 << CS01) | (1 << CS00); // prescaler 64
+  OCR0A = TICK_RELOAD;
+  TIMSK0 |= (1 << OCIE0A);
+}
+
+void wheelRun() {
+  uint16_t now;
+  Timer *timer;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { now = ticks; }
+
+  // catch up tick by tick, so late timers still fire in order
+  while (handled != now) {
+    handled++;
+    current = (current + 1) & (WHEEL_SLOTS - 1);
+
+    // move the due timers off the wheel first, the callbacks may arm and
+    // cancel timers on this slot
+    timer = slots[current];
+    while (timer) {
+      Timer *next = timer->next;
+      if (timer->rounds) {
+        timer->rounds--;
+      } else {
+        removeTimer(timer);
+        timer->prev = NULL;
+        timer->next = expired;
+        if (expired) {
+          expired->prev = timer;
+        }
+        expired = timer;
+        timer->list = &expired;
+      }
+      timer = next;
+    }
+
+    while ((timer = expired)) {
+      removeTimer(timer);
+      if (timer->period) {
+        addTimer(timer, timer->period);
+      }
+      timer->callback();
+    }
+  }
+}
+
+uint16_t wheelNow() { return handled; }
+
+void timerArm(Timer *timer, uint16_t ms, uint16_t period, void (*callback)()) {
+  timerCancel(timer);
+  timer->callback = callback;
+  timer->period = period;
+  addTimer(timer, ms);
+}
+
+void timerCancel(Timer *timer) {
+  if (timer->list) {
+    removeTimer(timer);
+  }
+}
+
+uint8_t timerArmed(const Timer *timer) { return timer->list != NULL; }
+
+static void addTimer(Timer *timer, uint16_t ms) {
+  if (ms == 0) {
+    ms = 1;
+  }
+  Timer **list = &slots[(current + ms) & (WHEEL_SLOTS - 1)];
+
+  // the slot comes around first after (ms - 1) % WHEEL_SLOTS + 1 ticks
+  timer->rounds = (ms - 1) >> WHEEL_SHIFT;
+  timer->prev = NULL;
+  timer->next = *list;
+  if (*list) {
+    (*list)->prev = timer;
+  }
+  *list = timer;
+  timer->list = list;
+}
+
+static void removeTimer(Timer *timer) {
+  if (timer->prev) {
+    timer->prev->next = timer->next;
+  } else {
+    *timer->list = timer->next;
+  }
+  if (timer->next) {
+    timer->next->prev = timer->prev;
+  }
+  timer->list = NULL;
+}
@@ -0,0 +1,173 @@
+// Host-side viewer for the LCD mirror (firmware built with -DLCD_MIRROR).
+//
+// usage: lcdview <tty> [cols]
+//
+// Renders the visible window (cols wide, 16 by default) of the mirrored
+// display in the terminal and keeps it up to date until interrupted. The
+// screen is complete after the next keyframe, at most MIRROR_KEYFRAME
+// updates after attaching.
+
+#include "include/proto.h"
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define DISPLAY_ON 0x04 // LCD_DISPLAYON
+
+static uint8_t ddram[PROTO_LCD_ROWS * PROTO_LCD_COLS];
+static uint8_t shift = 0;
+static uint8_t control = 0;
+static int received = 0; // a frame has been received
+
+// same as avr-libc's _crc_ccitt_update()
+static uint16_t crcCcittUpdate(uint16_t crc, uint8_t data) {
+  data ^= crc & 0xFF;
+  data ^= data << 4;
+  return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^
+          ((uint16_t)data << 3));
+}
+
+static void usage() {
+  fprintf(stderr, "usage: lcdview <tty> [cols]\n");
+  exit(2);
+}
+
+static int openPort(const char *path) {
+  int fd = open(path, O_RDONLY | O_NOCTTY);
+  if (fd < 0) {
+    perror(path);
+    exit(1);
+  }
+
+  struct termios tio;
+  if (tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B9600);
+    cfsetospeed(&tio, B9600);
+    // wait for data as long as it takes
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  return fd;
+}
+
+static uint8_t readByte(int fd) {
+  uint8_t byte;
+  if (read(fd, &byte, 1) != 1) {
+    fprintf(stderr, "lcdview: port closed\n");
+    exit(1);
+  }
+  return byte;
+}
+
+// wait for a mirror frame, other frames and corrupted ones are skipped
+static uint8_t receiveFrame(int fd, uint8_t *data) {
+  for (;;) {
+    while (readByte(fd) != PROTO_SOF)
+      ;
+
+    uint16_t crc = 0xFFFF;
+    uint8_t len = readByte(fd);
+    uint8_t cmd = readByte(fd);
+    if (len > PROTO_MAX_PAYLOAD) {
+      continue;
+    }
+    crc = crcCcittUpdate(crc, len);
+    crc = crcCcittUpdate(crc, cmd);
+    for (int i = 0; i < len; i++) {
+      data[i] = readByte(fd);
+      crc = crcCcittUpdate(crc, data[i]);
+    }
+    crc ^= readByte(fd);
+    crc ^= readByte(fd) << 8;
+    if (!crc && cmd == PROTO_LCD && len >= 2) {
+      return len;
+    }
+  }
+}
+
+// apply the changes of a frame, returns 0 if it's malformed
+static int apply(const uint8_t *data, uint8_t len) {
+  if (data[0] >= PROTO_LCD_COLS) {
+    return 0;
+  }
+  for (int i = 2; i < len; i += 2 + data[i + 1]) {
+    if (i + 2 > len || i + 2 + data[i + 1] > len ||
+        data[i] + data[i + 1] > (int)sizeof(ddram)) {
+      return 0;
+    }
+  }
+
+  shift = data[0];
+  control = data[1];
+  for (int i = 2; i < len; i += 2 + data[i + 1]) {
+    memcpy(&ddram[data[i]], &data[i + 2], data[i + 1]);
+  }
+  return 1;
+}
+
+static void draw(int cols) {
+  // home the cursor and redraw in place
+  printf("\033[H+");
+  for (int col = 0; col < cols; col++) {
+    putchar('-');
+  }
+  printf("+\033[K\n");
+
+  for (int row = 0; row < PROTO_LCD_ROWS; row++) {
+    putchar('|');
+    for (int col = 0; col < cols; col++) {
+      uint8_t c = ddram[row * PROTO_LCD_COLS + (shift + col) % PROTO_LCD_COLS];
+      if (!(control & DISPLAY_ON)) {
+        c = ' ';
+      } else if (c < 0x20 || c > 0x7D) {
+        // custom characters and the Japanese half of the ROM
+        c = '?';
+      }
+      putchar(c);
+    }
+    printf("|\033[K\n");
+  }
+
+  putchar('+');
+  for (int col = 0; col < cols; col++) {
+    putchar('-');
+  }
+  printf("+\033[K\n%s\033[K\n", !received                   ? "waiting..."
+                                : (control & DISPLAY_ON) ? ""
+                                                         : "display off");
+  fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+  uint8_t data[PROTO_MAX_PAYLOAD];
+  int cols = 16;
+
+  if (argc < 2 || argc > 3) {
+    usage();
+  }
+  if (argc == 3) {
+    cols = atoi(argv[2]);
+    if (cols < 1 || cols > PROTO_LCD_COLS) {
+      usage();
+    }
+  }
+
+  int fd = openPort(argv[1]);
+  memset(ddram, ' ', sizeof(ddram));
+  printf("\033[2J");
+  draw(cols);
+
+  for (;;) {
+    uint8_t len = receiveFrame(fd, data);
+    if (apply(data, len)) {
+      received = 1;
+      draw(cols);
+    }
+  }
+}
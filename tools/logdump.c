@@ -0,0 +1,178 @@
+// Host-side decoder for the binary debug log (include/log.h).
+//
+// usage: logdump <logfmt> <tty>
+//
+// <logfmt> holds the format strings extracted by `make logfmt`, it has to
+// come from the same build as the firmware. Prints every message with the
+// host time it arrived at until interrupted, other frames are skipped.
+
+#include "include/proto.h"
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+static char *formats;   // the .logfmt section, NUL-terminated strings
+static long formatSize; // its size
+
+// same as avr-libc's _crc_ccitt_update()
+static uint16_t crcCcittUpdate(uint16_t crc, uint8_t data) {
+  data ^= crc & 0xFF;
+  data ^= data << 4;
+  return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^
+          ((uint16_t)data << 3));
+}
+
+static void usage() {
+  fprintf(stderr, "usage: logdump <logfmt> <tty>\n");
+  exit(2);
+}
+
+static void loadFormats(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    perror(path);
+    exit(1);
+  }
+  fseek(file, 0, SEEK_END);
+  formatSize = ftell(file);
+  rewind(file);
+  // one more NUL in case the last string is cut off
+  formats = calloc(formatSize + 1, 1);
+  if (!formats || fread(formats, 1, formatSize, file) != (size_t)formatSize) {
+    fprintf(stderr, "logdump: can't read %s\n", path);
+    exit(1);
+  }
+  fclose(file);
+}
+
+static int openPort(const char *path) {
+  int fd = open(path, O_RDONLY | O_NOCTTY);
+  if (fd < 0) {
+    perror(path);
+    exit(1);
+  }
+
+  struct termios tio;
+  if (tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B9600);
+    cfsetospeed(&tio, B9600);
+    // wait for data as long as it takes
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  return fd;
+}
+
+static uint8_t readByte(int fd) {
+  uint8_t byte;
+  if (read(fd, &byte, 1) != 1) {
+    exit(0);
+  }
+  return byte;
+}
+
+// wait for a log frame, other frames and corrupted ones are skipped
+static uint8_t receiveFrame(int fd, uint8_t *data) {
+  for (;;) {
+    while (readByte(fd) != PROTO_SOF)
+      ;
+
+    uint16_t crc = 0xFFFF;
+    uint8_t len = readByte(fd);
+    uint8_t cmd = readByte(fd);
+    if (len > PROTO_MAX_PAYLOAD) {
+      continue;
+    }
+    crc = crcCcittUpdate(crc, len);
+    crc = crcCcittUpdate(crc, cmd);
+    for (int i = 0; i < len; i++) {
+      data[i] = readByte(fd);
+      crc = crcCcittUpdate(crc, data[i]);
+    }
+    crc ^= readByte(fd);
+    crc ^= readByte(fd) << 8;
+    if (!crc && cmd == PROTO_LOG && len >= 2 && !(len & 1)) {
+      return len;
+    }
+  }
+}
+
+// print a message, the arguments are 16-bit little-endian
+static void print(const char *fmt, const uint8_t *args, int count) {
+  char spec[16];
+
+  while (*fmt) {
+    if (*fmt != '%') {
+      putchar(*fmt++);
+      continue;
+    }
+
+    // copy the conversion without its length modifier
+    int len = 0;
+    spec[len++] = *fmt++;
+    while (*fmt && !strchr("diuxXc%", *fmt) && len < (int)sizeof(spec) - 3) {
+      if (*fmt != 'h' && *fmt != 'l') {
+        spec[len++] = *fmt;
+      }
+      fmt++;
+    }
+    if (!*fmt) {
+      break;
+    }
+    char conv = *fmt++;
+    spec[len++] = conv;
+    spec[len] = '\0';
+
+    if (conv == '%') {
+      putchar('%');
+    } else if (count <= 0) {
+      printf("<?>");
+    } else {
+      uint16_t value = args[0] | args[1] << 8;
+      // %d and %i are signed on the AVR too
+      int arg = strchr("di", conv) ? (int16_t)value : value;
+      printf(spec, arg);
+      args += 2;
+      count--;
+    }
+  }
+  putchar('\n');
+}
+
+int main(int argc, char **argv) {
+  uint8_t data[PROTO_MAX_PAYLOAD];
+
+  if (argc != 3) {
+    usage();
+  }
+  loadFormats(argv[1]);
+  int fd = openPort(argv[2]);
+
+  for (;;) {
+    uint8_t len = receiveFrame(fd, data);
+    uint16_t id = data[0] | data[1] << 8;
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    char stamp[16];
+    strftime(stamp, sizeof(stamp), "%H:%M:%S", localtime(&now.tv_sec));
+    printf("%s.%03ld ", stamp, (long)now.tv_usec / 1000);
+
+    if (id >= formatSize) {
+      printf("? unknown message %u\n", id);
+    } else {
+      // the level letter comes first
+      printf("%c ", formats[id]);
+      print(formats + id + 1, data + 2, (len - 2) / 2);
+    }
+    fflush(stdout);
+  }
+}
@@ -0,0 +1,160 @@
+#!/bin/sh
+# Worst-case RAM use: static data plus the deepest stack of main() with the
+# deepest interrupt on top of it.
+# usage: ramreport.sh <objdump> <elf> <ram-bytes> <objects...>
+# The objects must be compiled with -fstack-usage, their .su files give the
+# frame of every function (return address and saved registers included).
+# Calls are read from the relocations of the objects. An indirect call
+# (icall) is taken to reach the deepest function whose address is taken,
+# unless that function is already on the path. Library functions have no
+# .su file and are listed, not counted.
+
+objdump="$1"
+elf="$2"
+ram="$3"
+shift 3
+
+su=""
+for object in "$@"; do
+  su="$su ${object%.o}.su"
+done
+
+{
+  echo "@SECTIONS"
+  "$objdump" -h "$elf"
+  echo "@FRAMES"
+  cat $su
+  echo "@CODE"
+  "$objdump" -dr "$@"
+  echo "@RELOCS"
+  "$objdump" -r "$@"
+} | awk -v ram="$ram" '
+  function hex(s,    n, i) {
+    n = 0
+    for (i = 1; i <= length(s); i++) {
+      n = n * 16 + index("0123456789abcdef", tolower(substr(s, i, 1))) - 1
+    }
+    return n
+  }
+
+  # strip an offset (foo+0x12) from a relocation target
+  function symbol(s) {
+    sub(/[+-]0x[0-9a-fA-F]+$/, "", s)
+    return s
+  }
+
+  # deepest stack below f, the chain is left in chain[f]
+  function depth(f,    worst, best, n, i, g, d, callee) {
+    if (f in onPath) {
+      return 0
+    }
+    if (!(f in frame)) {
+      unknown[f] = 1
+    }
+    onPath[f] = 1
+    worst = 0
+    best = ""
+    n = split(calls[f], callee, " ")
+    for (i = 1; i <= n; i++) {
+      d = depth(callee[i])
+      if (d > worst) {
+        worst = d
+        best = chain[callee[i]]
+      }
+    }
+    if (f in indirect) {
+      for (g in taken) {
+        d = depth(g)
+        if (d > worst) {
+          worst = d
+          best = "(icall) " chain[g]
+        }
+      }
+    }
+    delete onPath[f]
+    chain[f] = best == "" ? f : f " > " best
+    return frame[f] + worst
+  }
+
+  /^@/ { part = $1; next }
+
+  part == "@SECTIONS" && ($2 == ".data" || $2 == ".bss" || $2 == ".noinit") {
+    size[$2] = hex($3)
+  }
+
+  # src/main.c:88:5:main	12	static
+  part == "@FRAMES" {
+    split($0, field, "\t")
+    n = split(field[1], where, ":")
+    f = where[n]
+    if (field[2] + 0 > frame[f]) {
+      frame[f] = field[2] + 0
+    }
+    if (field[3] == "dynamic") {
+      dynamic[f] = 1
+    }
+  }
+
+  part == "@CODE" && /^[0-9a-f]+ <[^>]+>:$/ {
+    current = substr($2, 2, length($2) - 3)
+  }
+
+  part == "@CODE" && /^ +[0-9a-f]+:\t/ {
+    split($0, field, "\t")
+    if (field[3] ~ /^ *e?i(call|jmp)/) {
+      indirect[current] = 1
+    }
+  }
+
+  part == "@CODE" && /R_AVR_(CALL|13_PCREL)/ {
+    g = symbol($NF)
+    if (g != current && g !~ /^\./ && !((current, g) in edge)) {
+      edge[current, g] = 1
+      calls[current] = calls[current] " " g
+    }
+  }
+
+  part == "@RELOCS" && /R_AVR_(16_PM|LO8_LDI_GS|HI8_LDI_GS)/ {
+    g = symbol($NF)
+    if (g !~ /^\./) {
+      taken[g] = 1
+    }
+  }
+
+  END {
+    static = size[".data"] + size[".bss"] + size[".noinit"]
+    stack = depth("main")
+    path = chain["main"]
+
+    isr = 0
+    for (f in frame) {
+      if (f ~ /^__vector_[0-9]+$/ && (d = depth(f)) > isr) {
+        isr = d
+        isrPath = chain[f]
+      }
+    }
+
+    total = static + stack + isr
+    printf "static  %5d  .data %d, .bss %d, .noinit %d\n", static,
+           size[".data"], size[".bss"], size[".noinit"]
+    printf "main    %5d  %s\n", stack, path
+    printf "isr     %5d  %s\n", isr, isr == 0 ? "-" : isrPath
+    printf "total   %5d  of %d, %d free\n", total, ram, ram - total
+
+    list = ""
+    for (f in unknown) {
+      list = list " " f
+    }
+    if (list != "") {
+      print "not counted (no .su):" list
+    }
+    list = ""
+    for (f in dynamic) {
+      list = list " " f
+    }
+    if (list != "") {
+      print "dynamic frames, lower bounds:" list
+    }
+    exit (total > ram)
+  }
+'
@@ -0,0 +1,288 @@
+// Host-side command line tool for the serial command protocol.
+//
+// usage: shctl <tty> read <reg>...
+//        shctl <tty> write <reg>=<value>...
+//        shctl <tty> time|alarm HH:MM:SS
+//        shctl <tty> password <digits>
+//
+// <tty> is the board's serial port or a simulator pseudo-terminal,
+// registers are given by name (see `shctl -h`) or number. The registers of
+// the second and further zones are named z<zone>.<field>, e.g. z2.temp.
+
+#include "include/proto.h"
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+static const char *names[REG_ZONES] = {
+    [REG_TEMP] = "temp",         [REG_MOTOR_ON] = "motor",
+    [REG_SPEED] = "speed",       [REG_STATE] = "state",
+    [REG_MAX_SPEED] = "maxspeed", [REG_THRESHOLD] = "threshold",
+    [REG_TIME_H] = "time_h",     [REG_TIME_M] = "time_m",
+    [REG_TIME_S] = "time_s",     [REG_ALARM_H] = "alarm_h",
+    [REG_ALARM_M] = "alarm_m",   [REG_ALARM_S] = "alarm_s",
+    [REG_PASSWORD_0] = "pass0",  [REG_PASSWORD_1] = "pass1",
+    [REG_PASSWORD_2] = "pass2",  [REG_PASSWORD_3] = "pass3",
+    [REG_EVENTS_DROPPED] = "dropped",
+};
+
+static const char *zoneNames[ZONE_REGS] = {
+    [ZONE_REG_TEMP] = "temp",
+    [ZONE_REG_MOTOR_ON] = "motor",
+    [ZONE_REG_SPEED] = "speed",
+    [ZONE_REG_MAX_SPEED] = "maxspeed",
+    [ZONE_REG_THRESHOLD] = "threshold",
+};
+
+static const char *errors[] = {
+    [PROTO_ERR_CRC] = "bad CRC",
+    [PROTO_ERR_CMD] = "unknown command",
+    [PROTO_ERR_LENGTH] = "bad length",
+    [PROTO_ERR_REG] = "unknown register",
+    [PROTO_ERR_ACCESS] = "access denied",
+    [PROTO_ERR_VALUE] = "value out of range",
+};
+
+// same as avr-libc's _crc_ccitt_update()
+static uint16_t crcCcittUpdate(uint16_t crc, uint8_t data) {
+  data ^= crc & 0xFF;
+  data ^= data << 4;
+  return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^
+          ((uint16_t)data << 3));
+}
+
+// name of a register, or NULL if it doesn't exist
+static const char *registerName(int reg) {
+  static char name[32];
+
+  if (reg < REG_ZONES) {
+    return names[reg];
+  }
+  if (reg >= REG_COUNT) {
+    return NULL;
+  }
+  snprintf(name, sizeof(name), "z%d.%s", (reg - REG_ZONES) / ZONE_REGS + 2,
+           zoneNames[(reg - REG_ZONES) % ZONE_REGS]);
+  return name;
+}
+
+static void usage() {
+  fprintf(stderr, "usage: shctl <tty> read <reg>...\n"
+                  "       shctl <tty> write <reg>=<value>...\n"
+                  "       shctl <tty> time|alarm HH:MM:SS\n"
+                  "       shctl <tty> password <digits>\n"
+                  "registers:");
+  for (int i = 0; i < REG_COUNT; i++) {
+    fprintf(stderr, " %s", registerName(i));
+  }
+  fprintf(stderr, "\n");
+  exit(2);
+}
+
+static int openPort(const char *path) {
+  int fd = open(path, O_RDWR | O_NOCTTY);
+  if (fd < 0) {
+    perror(path);
+    exit(1);
+  }
+
+  struct termios tio;
+  if (tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B9600);
+    cfsetospeed(&tio, B9600);
+    // reads return after 1s without data
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 10;
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  return fd;
+}
+
+static int parseRegister(const char *str) {
+  for (int i = 0; i < REG_COUNT; i++) {
+    if (strcmp(str, registerName(i)) == 0) {
+      return i;
+    }
+  }
+  char *end;
+  long reg = strtol(str, &end, 0);
+  if (*str == '\0' || *end != '\0' || reg < 0 || reg > 0xFF) {
+    fprintf(stderr, "shctl: unknown register '%s'\n", str);
+    exit(2);
+  }
+  return reg;
+}
+
+static uint8_t parseValue(const char *str) {
+  char *end;
+  long value = strtol(str, &end, 0);
+  if (*str == '\0' || *end != '\0' || value < 0 || value > 0xFF) {
+    fprintf(stderr, "shctl: bad value '%s'\n", str);
+    exit(2);
+  }
+  return value;
+}
+
+static void sendFrame(int fd, uint8_t cmd, const uint8_t *data, uint8_t len) {
+  uint8_t frame[PROTO_MAX_PAYLOAD + 5];
+  uint16_t crc = 0xFFFF;
+
+  frame[0] = PROTO_SOF;
+  frame[1] = len;
+  frame[2] = cmd;
+  memcpy(frame + 3, data, len);
+  for (int i = 1; i < len + 3; i++) {
+    crc = crcCcittUpdate(crc, frame[i]);
+  }
+  frame[len + 3] = crc & 0xFF;
+  frame[len + 4] = crc >> 8;
+
+  if (write(fd, frame, len + 5) != len + 5) {
+    perror("shctl: write");
+    exit(1);
+  }
+}
+
+static int readByte(int fd) {
+  uint8_t byte;
+  if (read(fd, &byte, 1) != 1) {
+    fprintf(stderr, "shctl: timeout\n");
+    exit(1);
+  }
+  return byte;
+}
+
+// wait for a reply frame, returns its command
+static uint8_t receiveFrame(int fd, uint8_t *data, uint8_t *len) {
+  while (readByte(fd) != PROTO_SOF)
+    ;
+
+  uint16_t crc = 0xFFFF;
+  *len = readByte(fd);
+  uint8_t cmd = readByte(fd);
+  if (*len > PROTO_MAX_PAYLOAD) {
+    fprintf(stderr, "shctl: bad reply length %d\n", *len);
+    exit(1);
+  }
+  crc = crcCcittUpdate(crc, *len);
+  crc = crcCcittUpdate(crc, cmd);
+  for (int i = 0; i < *len; i++) {
+    data[i] = readByte(fd);
+    crc = crcCcittUpdate(crc, data[i]);
+  }
+  crc ^= readByte(fd);
+  crc ^= readByte(fd) << 8;
+  if (crc) {
+    fprintf(stderr, "shctl: bad reply CRC\n");
+    exit(1);
+  }
+
+  // the LCD mirror streams in between, that's not the reply
+  if (cmd == PROTO_LCD) {
+    return receiveFrame(fd, data, len);
+  }
+
+  if (cmd == PROTO_ERROR) {
+    uint8_t code = (*len > 0) ? data[0] : 0;
+    const char *msg = "unknown error";
+    if (code < sizeof(errors) / sizeof(errors[0]) && errors[code]) {
+      msg = errors[code];
+    }
+    fprintf(stderr, "shctl: %s (byte %d)\n", msg, (*len > 1) ? data[1] : 0);
+    exit(1);
+  }
+  return cmd;
+}
+
+// turn "HH:MM:SS" into three register writes starting at reg
+static uint8_t parseClock(const char *str, uint8_t reg, uint8_t *data) {
+  unsigned h, m, s;
+  if (sscanf(str, "%u:%u:%u", &h, &m, &s) != 3) {
+    fprintf(stderr, "shctl: bad time '%s'\n", str);
+    exit(2);
+  }
+  uint8_t values[3] = {h, m, s};
+  for (int i = 0; i < 3; i++) {
+    data[2 * i] = reg + i;
+    data[2 * i + 1] = values[i];
+  }
+  return 6;
+}
+
+int main(int argc, char **argv) {
+  uint8_t data[PROTO_MAX_PAYLOAD];
+  uint8_t len = 0;
+  uint8_t cmd;
+
+  if (argc < 4) {
+    usage();
+  }
+  const char *op = argv[2];
+
+  if (strcmp(op, "read") == 0) {
+    cmd = PROTO_READ;
+    for (int i = 3; i < argc; i++) {
+      if (len == PROTO_MAX_PAYLOAD) {
+        fprintf(stderr, "shctl: too many registers\n");
+        return 2;
+      }
+      data[len++] = parseRegister(argv[i]);
+    }
+  } else if (strcmp(op, "write") == 0) {
+    cmd = PROTO_WRITE;
+    for (int i = 3; i < argc; i++) {
+      char *eq = strchr(argv[i], '=');
+      if (!eq) {
+        usage();
+      }
+      if (len + 2 > PROTO_MAX_PAYLOAD) {
+        fprintf(stderr, "shctl: too many registers\n");
+        return 2;
+      }
+      *eq = '\0';
+      data[len++] = parseRegister(argv[i]);
+      data[len++] = parseValue(eq + 1);
+    }
+  } else if (strcmp(op, "time") == 0 || strcmp(op, "alarm") == 0) {
+    cmd = PROTO_WRITE;
+    len = parseClock(argv[3], (op[0] == 't') ? REG_TIME_H : REG_ALARM_H, data);
+  } else if (strcmp(op, "password") == 0) {
+    cmd = PROTO_WRITE;
+    if (strlen(argv[3]) != 4) {
+      fprintf(stderr, "shctl: password must have 4 digits\n");
+      return 2;
+    }
+    for (int i = 0; i < 4; i++) {
+      data[len++] = REG_PASSWORD_0 + i;
+      data[len++] = argv[3][i];
+    }
+  } else {
+    usage();
+  }
+
+  int fd = openPort(argv[1]);
+  sendFrame(fd, cmd, data, len);
+
+  uint8_t request[PROTO_MAX_PAYLOAD];
+  uint8_t requestLen = len;
+  memcpy(request, data, len);
+  receiveFrame(fd, data, &len);
+
+  if (cmd == PROTO_READ) {
+    for (int i = 0; i < len && i < requestLen; i++) {
+      if (registerName(request[i])) {
+        printf("%s=%d\n", registerName(request[i]), data[i]);
+      } else {
+        printf("%d=%d\n", request[i], data[i]);
+      }
+    }
+  }
+
+  close(fd);
+  return 0;
+}
@@ -0,0 +1,109 @@
+// Host-side recorder for input traces (firmware built with -DTRACE_RECORD).
+//
+// usage: tracecap <tty> <trace>
+//
+// Saves the records of every PROTO_TRACE frame to <trace> until interrupted.
+// The firmware starts a trace at boot, so start tracecap and then reset the
+// board. Replay the file with build/replay/replay (`make replay`).
+
+#include "include/proto.h"
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+// same as avr-libc's _crc_ccitt_update()
+static uint16_t crcCcittUpdate(uint16_t crc, uint8_t data) {
+  data ^= crc & 0xFF;
+  data ^= data << 4;
+  return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^
+          ((uint16_t)data << 3));
+}
+
+static void usage() {
+  fprintf(stderr, "usage: tracecap <tty> <trace>\n");
+  exit(2);
+}
+
+static int openPort(const char *path) {
+  int fd = open(path, O_RDONLY | O_NOCTTY);
+  if (fd < 0) {
+    perror(path);
+    exit(1);
+  }
+
+  struct termios tio;
+  if (tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B9600);
+    cfsetospeed(&tio, B9600);
+    // wait for data as long as it takes
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  return fd;
+}
+
+static uint8_t readByte(int fd) {
+  uint8_t byte;
+  if (read(fd, &byte, 1) != 1) {
+    fprintf(stderr, "tracecap: port closed\n");
+    exit(1);
+  }
+  return byte;
+}
+
+// wait for a trace frame, other frames and corrupted ones are skipped
+static uint8_t receiveFrame(int fd, uint8_t *data) {
+  for (;;) {
+    while (readByte(fd) != PROTO_SOF)
+      ;
+
+    uint16_t crc = 0xFFFF;
+    uint8_t len = readByte(fd);
+    uint8_t cmd = readByte(fd);
+    if (len > PROTO_MAX_PAYLOAD) {
+      continue;
+    }
+    crc = crcCcittUpdate(crc, len);
+    crc = crcCcittUpdate(crc, cmd);
+    for (int i = 0; i < len; i++) {
+      data[i] = readByte(fd);
+      crc = crcCcittUpdate(crc, data[i]);
+    }
+    crc ^= readByte(fd);
+    crc ^= readByte(fd) << 8;
+    if (!crc && cmd == PROTO_TRACE) {
+      return len;
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  uint8_t data[PROTO_MAX_PAYLOAD];
+  long records = 0;
+
+  if (argc != 3) {
+    usage();
+  }
+  int fd = openPort(argv[1]);
+  FILE *file = fopen(argv[2], "wb");
+  if (!file) {
+    perror(argv[2]);
+    return 1;
+  }
+
+  for (;;) {
+    uint8_t len = receiveFrame(fd, data);
+    // saved as they arrive, so an interrupted capture keeps everything
+    if (fwrite(data, 1, len, file) != len || fflush(file) != 0) {
+      perror(argv[2]);
+      return 1;
+    }
+    records += len / 3; // TRACE_RECORD_SIZE
+    fprintf(stderr, "\r%ld records", records);
+  }
+}